@@ -0,0 +1,261 @@
+// Times the application of the operators of examples/bratu and
+// examples/diffusion-convection, once composed at run time
+// (nosh::fvm_operator) and once at compile time (nosh::static_fvm_operator).
+#include <nosh.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_GlobalMPISession.hpp>
+#include <Teuchos_StandardCatchMacros.hpp>
+
+namespace
+{
+  // control volumes on the local (overlap) vertices
+  std::vector<double>
+  overlap_control_volumes(const std::shared_ptr<const nosh::mesh> & mesh)
+  {
+    Tpetra::Vector<double,int,int> cv(Teuchos::rcp(mesh->overlap_map()));
+    cv.doImport(*mesh->control_volumes(), *mesh->importer(), Tpetra::INSERT);
+    const auto data = cv.getData();
+    return std::vector<double>(data.begin(), data.end());
+  }
+
+  // integrate(lambda x: -n_dot_grad(u(x)), dS)
+  class laplace_core: public nosh::operator_core_edge
+  {
+    public:
+      explicit laplace_core(const std::shared_ptr<const nosh::mesh> & mesh):
+        mesh_(mesh),
+        edge_data_(mesh->get_edge_data())
+      {}
+
+      std::tuple<double,double>
+      eval(
+          const moab::EntityHandle & edge,
+          const Teuchos::ArrayRCP<const double> & u
+          ) const override
+      {
+        const auto k = mesh_->local_index(edge);
+        const auto & lids = mesh_->edge_lids[k];
+        const double alpha = edge_data_[k].covolume / edge_data_[k].length;
+        const double val = alpha * (u[lids[0]] - u[lids[1]]);
+        return std::make_tuple(val, -val);
+      }
+
+    private:
+      const std::shared_ptr<const nosh::mesh> mesh_;
+      const std::vector<nosh::mesh::edge_data> edge_data_;
+  };
+
+  // integrate(lambda x: dot(n, a) * u(x), dS) with a = (-1, -1, 0)
+  class convection_core: public nosh::operator_core_edge
+  {
+    public:
+      explicit convection_core(const std::shared_ptr<const nosh::mesh> & mesh):
+        mesh_(mesh),
+        edge_data_(mesh->get_edge_data())
+      {}
+
+      std::tuple<double,double>
+      eval(
+          const moab::EntityHandle & edge,
+          const Teuchos::ArrayRCP<const double> & u
+          ) const override
+      {
+        const auto k = mesh_->local_index(edge);
+        const auto & lids = mesh_->edge_lids[k];
+        const auto & coords = mesh_->vertex_coords();
+        // dot(x1 - x0, a)
+        const double dx_a =
+          - (coords.x[lids[1]] - coords.x[lids[0]])
+          - (coords.y[lids[1]] - coords.y[lids[0]]);
+        const double val =
+          edge_data_[k].covolume * dx_a / edge_data_[k].length
+          * 0.5 * (u[lids[0]] + u[lids[1]]);
+        return std::make_tuple(val, -val);
+      }
+
+    private:
+      const std::shared_ptr<const nosh::mesh> mesh_;
+      const std::vector<nosh::mesh::edge_data> edge_data_;
+  };
+
+  // - integrate(lambda x: alpha * exp(u(x)), dV)
+  class bratu_core: public nosh::operator_core_vertex
+  {
+    public:
+      explicit bratu_core(const std::shared_ptr<const nosh::mesh> & mesh):
+        mesh_(mesh),
+        control_volumes_(overlap_control_volumes(mesh))
+      {}
+
+      double
+      eval(
+          const moab::EntityHandle & vertex,
+          const Teuchos::ArrayRCP<const double> & u
+          ) const override
+      {
+        const auto k = mesh_->local_index(vertex);
+        return -0.001 * control_volumes_[k] * std::exp(u[k]);
+      }
+
+    private:
+      const std::shared_ptr<const nosh::mesh> mesh_;
+      const std::vector<double> control_volumes_;
+  };
+
+  // - integrate(lambda x: 1.0, dV)
+  class source_core: public nosh::operator_core_vertex
+  {
+    public:
+      explicit source_core(const std::shared_ptr<const nosh::mesh> & mesh):
+        mesh_(mesh),
+        control_volumes_(overlap_control_volumes(mesh))
+      {}
+
+      double
+      eval(
+          const moab::EntityHandle & vertex,
+          const Teuchos::ArrayRCP<const double> & u
+          ) const override
+      {
+        (void) u;
+        return -control_volumes_[mesh_->local_index(vertex)];
+      }
+
+    private:
+      const std::shared_ptr<const nosh::mesh> mesh_;
+      const std::vector<double> control_volumes_;
+  };
+
+  // u(x) on the boundary
+  class boundary_value_core: public nosh::operator_core_dirichlet
+  {
+    public:
+      explicit boundary_value_core(const std::shared_ptr<const nosh::mesh> & mesh):
+        nosh::operator_core_dirichlet({"boundary"}),
+        mesh_(mesh)
+      {}
+
+      double
+      eval(
+          const moab::EntityHandle & vertex,
+          const Teuchos::ArrayRCP<const double> & u
+          ) const override
+      {
+        return u[mesh_->local_index(vertex)];
+      }
+
+    private:
+      const std::shared_ptr<const nosh::mesh> mesh_;
+  };
+
+  double
+  time_per_apply(
+      const Tpetra::Operator<double,int,int> & op,
+      const int num_applies
+      )
+  {
+    const auto comm = op.getDomainMap()->getComm();
+    Tpetra::Vector<double,int,int> x(op.getDomainMap());
+    Tpetra::Vector<double,int,int> y(op.getRangeMap());
+    x.randomize();
+
+    // warm-up
+    op.apply(x, y);
+
+    comm->barrier();
+    const auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < num_applies; k++) {
+      op.apply(x, y);
+    }
+    comm->barrier();
+    const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    return elapsed.count() / num_applies;
+  }
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Teuchos::GlobalMPISession session(&argc, &argv, NULL);
+  auto out = Teuchos::VerboseObjectBase::getDefaultOStream();
+
+  bool success = true;
+  try {
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        argc < 2,
+        "Usage: " << argv[0] << " <mesh file> [number of applies]"
+        );
+    const std::string file_name = argv[1];
+    const int num_applies = (argc > 2) ? std::stoi(argv[2]) : 100;
+
+    const auto comm = Teuchos::DefaultComm<int>::getComm();
+    const std::shared_ptr<const nosh::mesh> mesh = nosh::read(file_name);
+
+    const auto laplace = std::make_shared<laplace_core>(mesh);
+    const auto convection = std::make_shared<convection_core>(mesh);
+    const auto bratu = std::make_shared<bratu_core>(mesh);
+    const auto source = std::make_shared<source_core>(mesh);
+    const auto boundary_value = std::make_shared<boundary_value_core>(mesh);
+
+    // examples/bratu, F
+    const nosh::fvm_operator bratu_dynamic(
+        mesh, {laplace}, {bratu}, {}, {boundary_value}, {}
+        );
+    const nosh::static_fvm_operator<
+      std::tuple<laplace_core>,
+      std::tuple<bratu_core>,
+      std::tuple<>
+      > bratu_static(
+        mesh,
+        std::make_tuple(laplace),
+        std::make_tuple(bratu),
+        std::make_tuple(),
+        {boundary_value},
+        {}
+        );
+
+    // examples/diffusion-convection, as an operator
+    const nosh::fvm_operator dc_dynamic(
+        mesh, {laplace, convection}, {source}, {}, {boundary_value}, {}
+        );
+    const nosh::static_fvm_operator<
+      std::tuple<laplace_core, convection_core>,
+      std::tuple<source_core>,
+      std::tuple<>
+      > dc_static(
+        mesh,
+        std::make_tuple(laplace, convection),
+        std::make_tuple(source),
+        std::make_tuple(),
+        {boundary_value},
+        {}
+        );
+
+    const std::vector<std::tuple<std::string, const Tpetra::Operator<double,int,int> *>>
+      ops = {
+        std::make_tuple("bratu, dynamic", &bratu_dynamic),
+        std::make_tuple("bratu, static", &bratu_static),
+        std::make_tuple("diffusion-convection, dynamic", &dc_dynamic),
+        std::make_tuple("diffusion-convection, static", &dc_static)
+      };
+    for (const auto & op: ops) {
+      const double t = time_per_apply(*std::get<1>(op), num_applies);
+      if (comm->getRank() == 0) {
+        std::cout
+          << std::get<0>(op) << ",  time per apply: " << t << " s"
+          << std::endl;
+      }
+    }
+  }
+  TEUCHOS_STANDARD_CATCH_STATEMENTS(true, *out, success);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
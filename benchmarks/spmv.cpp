@@ -0,0 +1,69 @@
+// Times the application of the kinetic energy operator for the different
+// vertex orderings of a mesh.
+#include <nosh.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <Teuchos_DefaultComm.hpp>
+#include <Teuchos_GlobalMPISession.hpp>
+#include <Teuchos_StandardCatchMacros.hpp>
+
+int main(int argc, char *argv[]) {
+  Teuchos::GlobalMPISession session(&argc, &argv, NULL);
+  auto out = Teuchos::VerboseObjectBase::getDefaultOStream();
+
+  bool success = true;
+  try {
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        argc < 2,
+        "Usage: " << argv[0] << " <mesh file> [number of applies]"
+        );
+    const std::string file_name = argv[1];
+    const int num_applies = (argc > 2) ? std::stoi(argv[2]) : 100;
+
+    const auto comm = Teuchos::DefaultComm<int>::getComm();
+
+    for (const std::string ordering: {"file", "rcm", "morton"}) {
+      const auto mesh = nosh::read(file_name, false, ordering);
+
+      auto mvp =
+        std::make_shared<nosh::vector_field::explicit_values>(*mesh, "A", 1.0);
+      auto thickness =
+        std::make_shared<nosh::scalar_field::constant>(*mesh, 1.0);
+      nosh::parameter_matrix::keo keo(mesh, thickness, mvp);
+      keo.set_parameters({{"mu", 1.0}}, {});
+
+      Tpetra::Vector<double,int,int> x(keo.getDomainMap());
+      Tpetra::Vector<double,int,int> y(keo.getRangeMap());
+      x.randomize();
+
+      // warm-up
+      keo.apply(x, y);
+
+      comm->barrier();
+      const auto start = std::chrono::steady_clock::now();
+      for (int k = 0; k < num_applies; k++) {
+        keo.apply(x, y);
+      }
+      comm->barrier();
+      const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+      // one multiply and one add per nonzero
+      const double flops = 2.0 * keo.getGlobalNumEntries() * num_applies;
+      if (comm->getRank() == 0) {
+        std::cout
+          << "ordering: " << ordering
+          << ",  time per apply: " << elapsed.count() / num_applies << " s"
+          << ",  GFLOP/s: " << flops / elapsed.count() * 1.0e-9
+          << std::endl;
+      }
+    }
+  }
+  TEUCHOS_STANDARD_CATCH_STATEMENTS(true, *out, success);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -23,6 +23,9 @@ class Poisson(LinearFvmProblem):
             (lambda x: 1.0, Gamma1)
             ]
 
+    # keep the matrix symmetric for CG
+    symmetric_dirichlet = True
+
 
 # Alternative (raw) syntax:
 # class Core0(MatrixCore):
@@ -70,7 +70,11 @@ class TpetraCodeGenerator(object):
         '''
         out_vector = 'y%d' % self._intermediate_count
         self._intermediate_count += 1
-        self._code += '\nTpetra::Vector<double> %s(y->getMap());' % out_vector
+        # Borrow the vector from the pool instead of allocating it on every
+        # application of the generated operator.
+        self._code += '''
+const auto %s_borrowed = nosh::vector_pool::global().get(y->getMap());
+auto & %s = *%s_borrowed;''' % (out_vector, out_vector, out_vector)
         return out_vector
 
     def _to_vector(self, pointwise_code, out_vector):
@@ -24,6 +24,8 @@ class FvmMatrixCode(object):
         self.scalar_params = set()
         self.vector_params = set()
 
+        self.symmetric_dirichlet = cls.symmetric_dirichlet
+
         expr = cls.apply(u)
         self.dependencies = \
             gather_core_dependencies(
@@ -40,7 +42,8 @@ class FvmMatrixCode(object):
             'fvm_matrix.tpl',
             self.class_name,
             'nosh::fvm_matrix',
-            self.dependencies
+            self.dependencies,
+            self.symmetric_dirichlet
             )
 
         return {
@@ -115,7 +118,8 @@ def get_code_linear_problem(
         template_filename,
         class_name,
         base_class_name,
-        dependencies
+        dependencies,
+        symmetric_dirichlet=False
         ):
     # Go through the dependencies collect the cores.
     dirichlet_cores = []
@@ -169,12 +173,13 @@ def get_code_linear_problem(
             )
 
     members_init = [
-      '%s(\n_mesh,\n %s,\n %s,\n %s,\n %s\n)' %
+      '%s(\n_mesh,\n %s,\n %s,\n %s,\n %s%s\n)' %
       (base_class_name,
        init_matrix_core_edge,
        init_matrix_core_vertex,
        init_matrix_core_boundary,
-       init_matrix_core_dirichlet
+       init_matrix_core_dirichlet,
+       ',\n true' if symmetric_dirichlet else ''
        )
       ]
     members_declare = []
@@ -110,15 +110,17 @@ def get_code_linear_problem(
     constructor_args = [
         'const std::shared_ptr<const nosh::mesh> & _mesh'
         ]
-    init_operator_core_edge = '{%s}' % (
+    # The edge, vertex, and boundary cores are passed with their types such
+    # that nosh::static_fvm_operator can call them without virtual dispatch.
+    init_operator_core_edge = 'std::make_tuple(%s)' % (
             ', '.join(['std::make_shared<%s>(_mesh)' % n.class_name
                        for n in edge_cores])
             )
-    init_operator_core_vertex = '{%s}' % (
+    init_operator_core_vertex = 'std::make_tuple(%s)' % (
             ', '.join(['std::make_shared<%s>(_mesh)' % n.class_name
                        for n in vertex_cores])
             )
-    init_operator_core_boundary = '{%s}' % (
+    init_operator_core_boundary = 'std::make_tuple(%s)' % (
             ', '.join(['std::make_shared<%s>(_mesh)' % n.class_name
                        for n in boundary_cores])
             )
@@ -215,6 +217,12 @@ def get_code_linear_problem(
             'members_init': ',\n'.join(members_init),
             'members_declare': '\n'.join(members_declare),
             'extra_methods': '\n'.join(extra_methods),
+            'edge_core_types':
+                ', '.join([n.class_name for n in edge_cores]),
+            'vertex_core_types':
+                ', '.join([n.class_name for n in vertex_cores]),
+            'boundary_core_types':
+                ', '.join([n.class_name for n in boundary_cores]),
             'init_edge_cores': init_operator_core_edge,
             'init_vertex_cores': init_operator_core_vertex,
             'init_boundary_cores': init_operator_core_boundary,
@@ -209,8 +209,7 @@ def _get_extra(arguments, used_variables):
     if x0 in undefined_symbols:
         init.append('mesh_(mesh)')
         declare.append('const std::shared_ptr<const nosh::mesh> mesh_;')
-        body.append('const auto verts = this->mesh_->get_vertex_tuple(edge);')
-        body.append('const auto x0 = this->mesh_->get_coords(verts[0]);')
+        body.extend(_get_coords_body(0))
         undefined_symbols.remove(x0)
         if edge in unused_arguments:
             unused_arguments.remove(edge)
@@ -219,8 +218,7 @@ def _get_extra(arguments, used_variables):
     if x1 in undefined_symbols:
         init.append('mesh_(mesh)')
         declare.append('const std::shared_ptr<const nosh::mesh> mesh_;')
-        body.append('const auto verts = this->mesh_->get_vertex_tuple(edge);')
-        body.append('const auto x1 = this->mesh_->get_coords(verts[1]);')
+        body.extend(_get_coords_body(1))
         undefined_symbols.remove(x1)
         if edge in unused_arguments:
             unused_arguments.remove(edge)
@@ -228,9 +226,8 @@ def _get_extra(arguments, used_variables):
     if nfl.n in undefined_symbols:
         init.append('mesh_(mesh)')
         declare.append('const std::shared_ptr<const nosh::mesh> mesh_;')
-        body.append('const auto verts = this->mesh_->get_vertex_tuple(edge);')
-        body.append('const auto x0 = this->mesh_->get_coords(verts[0]);')
-        body.append('const auto x1 = this->mesh_->get_coords(verts[1]);')
+        body.extend(_get_coords_body(0))
+        body.extend(_get_coords_body(1))
         init.append('edge_data_(mesh->get_edge_data())')
         declare.append('const std::vector<nosh::mesh::edge_data> edge_data_;')
         body.append('const auto k = this->mesh_->local_index(edge);')
@@ -254,3 +251,16 @@ def _get_extra(arguments, used_variables):
         body.insert(0, '(void) %s;' % name)
 
     return body, init, declare
+
+
+def _get_coords_body(i):
+    # Read the coordinates of vertex i of the edge straight from the mesh's
+    # arrays; that doesn't allocate, unlike get_vertex_tuple().
+    return [
+        'const auto k = this->mesh_->local_index(edge);',
+        'const auto & lids = this->mesh_->edge_lids[k];',
+        'const auto & coords = this->mesh_->vertex_coords();',
+        ('const Eigen::Vector3d x%d('
+         'coords.x[lids[%d]], coords.y[lids[%d]], coords.z[lids[%d]]'
+         ');') % (i, i, i, i)
+        ]
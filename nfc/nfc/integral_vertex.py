@@ -124,6 +124,13 @@ class IntegralVertex(object):
                 code = src.substitute({
                     'name': self.class_name,
                     'return_value': extract_c_expression(self.expr),
+                    # row-major storage of num_vectors vectors
+                    'multi_return_value': extract_c_expression(
+                        self.expr.subs(
+                            sympy.IndexedBase('u')[sympy.Symbol('k')],
+                            sympy.Symbol('u[num_vectors*k + j]')
+                            )
+                        ),
                     'eval_body': '\n'.join(eval_body),
                     'members_init': ':\n' + ',\n'.join(init) if init else '',
                     'members_declare': '\n'.join(declare),
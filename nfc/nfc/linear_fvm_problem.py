@@ -16,6 +16,8 @@ class LinearFvmProblemCode(object):
         u = sympy.Function('u')
         u.nosh = True
 
+        self.symmetric_dirichlet = cls.symmetric_dirichlet
+
         res = cls.apply(u)
         self.dependencies = \
             gather_core_dependencies(
@@ -31,7 +33,8 @@ class LinearFvmProblemCode(object):
             'linear_fvm_problem.tpl',
             self.class_name,
             'nosh::linear_problem',
-            self.dependencies
+            self.dependencies,
+            self.symmetric_dirichlet
             )
 
         return {
@@ -41,6 +41,17 @@ class SubdomainCode(object):
         # No undefined variables allowed
         assert(len(used_vars - expr_arguments) == 0)
 
+        # The batched variant gets the coordinates as three arrays, indexed
+        # by k.
+        xk = [sympy.Symbol('x%d[k]' % i) for i in range(3)]
+        try:
+            batch_result = result.subs({x[i, 0]: xk[i] for i in range(3)})
+            batch_free_symbols = batch_result.free_symbols
+        except AttributeError:
+            # AttributeError: 'bool' object has no attribute 'subs'
+            batch_result = result
+            batch_free_symbols = set()
+
         try:
             ibo = 'true' if self.cls.is_boundary_only else 'false'
         except AttributeError:
@@ -58,6 +69,11 @@ class SubdomainCode(object):
                 'is_inside_body': '\n'.join(
                     ('(void) %s;' % name) for name in unused_arguments
                     ),
+                'is_inside_batch_return': extract_c_expression(batch_result),
+                'is_inside_batch_body': ''.join(
+                    ('(void) x%d;\n      ' % i)
+                    for i in range(3) if xk[i] not in batch_free_symbols
+                    ),
                 })
 
         return {
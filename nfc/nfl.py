@@ -98,6 +98,9 @@ class CoreList(object):
 class FvmMatrix(Callable, CoreList):
     # By default: No Dirichlet conditions.
     dirichlet = []
+    # Eliminate the Dirichlet columns, too, such that a symmetric matrix stays
+    # symmetric.
+    symmetric_dirichlet = False
 
     def __init__(self, arg):
         CoreList.__init__(self, [], [self])
@@ -105,7 +108,8 @@ class FvmMatrix(Callable, CoreList):
 
 
 class LinearFvmProblem(object):
-    pass
+    # See FvmMatrix.
+    symmetric_dirichlet = False
 
 
 class Measure(object):
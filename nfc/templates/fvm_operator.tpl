@@ -1,11 +1,19 @@
 class ${name}:
-  public nosh::fvm_operator
+  public nosh::static_fvm_operator<
+    std::tuple<${edge_core_types}>,
+    std::tuple<${vertex_core_types}>,
+    std::tuple<${boundary_core_types}>
+    >
 {
   public:
     ${name}(
         ${constructor_args}
         ):
-      nosh::fvm_operator(
+      nosh::static_fvm_operator<
+        std::tuple<${edge_core_types}>,
+        std::tuple<${vertex_core_types}>,
+        std::tuple<${boundary_core_types}>
+        >(
         _mesh,
         ${init_edge_cores},
         ${init_vertex_cores},
@@ -10,25 +10,39 @@ class ${name}:
       nosh::matrix_core_edge_data
       eval(const moab::EntityHandle & edge) const
       {
-        ${eval_body}
+        double lhs[4];
+        double rhs[2];
+        this->eval_batch(&edge, 1, lhs, rhs);
         return {
           {
-            {
-              ${edge00},
-                ${edge01},
-            },
-              {
-                ${edge10},
-                ${edge11},
-              }
+            {lhs[0], lhs[1]},
+            {lhs[2], lhs[3]}
           },
-          {
-            ${edge_affine0},
-            ${edge_affine1}
-          }
+          {rhs[0], rhs[1]}
         };
       }
 
+    virtual
+      void
+      eval_batch(
+          const moab::EntityHandle * edges,
+          const int num_edges,
+          double * lhs,
+          double * rhs
+          ) const
+      {
+        for (int i = 0; i < num_edges; i++) {
+          const moab::EntityHandle & edge = edges[i];
+          ${eval_body}
+          lhs[4*i] = ${edge00};
+          lhs[4*i + 1] = ${edge01};
+          lhs[4*i + 2] = ${edge10};
+          lhs[4*i + 3] = ${edge11};
+          rhs[2*i] = ${edge_affine0};
+          rhs[2*i + 1] = ${edge_affine1};
+        }
+      }
+
   private:
     ${members_declare}
 }; // class ${name}
@@ -17,6 +17,28 @@ class ${name}:
         return ${return_value};
       }
 
+    virtual
+      bool
+      has_eval_multi() const
+      {
+        return true;
+      }
+
+    virtual
+      void
+      eval_multi(
+        const moab::EntityHandle & vertex,
+        const double * u,
+        const int num_vectors,
+        double * vals
+        ) const
+      {
+        ${eval_body}
+        for (int j = 0; j < num_vectors; j++) {
+          vals[j] = ${multi_return_value};
+        }
+      }
+
     ${methods}
 
   private:
@@ -9,4 +9,17 @@ class ${name}: public nosh::subdomain
     is_inside(const Eigen::Vector3d & x) const {
       ${is_inside_body}return ${is_inside_return};
     }
+
+    virtual void
+    is_inside_batch(
+        const double * x0,
+        const double * x1,
+        const double * x2,
+        const int n,
+        char * inside
+        ) const {
+      ${is_inside_batch_body}for (int k = 0; k < n; k++) {
+        inside[k] = ${is_inside_batch_return};
+      }
+    }
 };  // class ${name}
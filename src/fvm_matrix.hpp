@@ -1,7 +1,15 @@
 #ifndef NOSH_FVM_MATRIX_H
 #define NOSH_FVM_MATRIX_H
 
+#include <array>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+#include <Teuchos_ParameterList.hpp>
+#include <Teuchos_RCPStdSharedPtrConversions.hpp>
 #include <Tpetra_CrsMatrix.hpp>
+#include <Tpetra_Import.hpp>
+#include <Tpetra_Vector.hpp>
 
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
 #include <Teuchos_Time.hpp>
@@ -12,6 +20,7 @@
 #include "matrix_core_boundary.hpp"
 #include "matrix_core_dirichlet.hpp"
 #include "mesh.hpp"
+#include "parallel_for.hpp"
 
 namespace nosh
 {
@@ -24,9 +33,10 @@ namespace nosh
           std::vector<std::shared_ptr<const matrix_core_edge>>  matrix_core_edges,
           std::vector<std::shared_ptr<const matrix_core_vertex>>  matrix_core_vertexs,
           std::vector<std::shared_ptr<const matrix_core_boundary>>  matrix_core_boundarys,
-          std::vector<std::shared_ptr<const matrix_core_dirichlet>>  dbcs
+          std::vector<std::shared_ptr<const matrix_core_dirichlet>>  dbcs,
+          const bool symmetric_dbcs = false
           ) :
-        Tpetra::CrsMatrix<double,int,int>(_mesh->build_graph()),
+        Tpetra::CrsMatrix<double,int,int>(_mesh->graph()),
         mesh(_mesh),
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
         fill_time_(Teuchos::TimeMonitor::getNewTimer("Nosh: fvm_matrix::fill_")),
@@ -34,8 +44,33 @@ namespace nosh
         matrix_core_edges_(std::move(matrix_core_edges)),
         matrix_core_vertexs_(std::move(matrix_core_vertexs)),
         matrix_core_boundarys_(std::move(matrix_core_boundarys)),
-        dbcs_(std::move(dbcs))
+        dbcs_(std::move(dbcs)),
+        overlap_matrix_(
+            !_mesh->is_distributed() ?
+            nullptr :
+            std::make_shared<Tpetra::CrsMatrix<double,int,int>>(
+              _mesh->overlap_graph()
+              )
+            ),
+        overlap_rhs_(
+            overlap_matrix_ ?
+            std::make_shared<Tpetra::Vector<double,int,int>>(
+              Teuchos::rcp(_mesh->overlap_map())
+              ) :
+            nullptr
+            ),
+        symmetric_dbcs_(symmetric_dbcs),
+        dirichlet_values_(
+            symmetric_dbcs ?
+            std::make_shared<Tpetra::Vector<double,int,int>>(
+              Teuchos::rcp(_mesh->map())
+              ) :
+            nullptr
+            ),
+        col_importer_(),
+        dirichlet_col_values_()
         {
+          this->build_dirichlet_masks_();
         }
 
       ~fvm_matrix() override = default;
@@ -59,9 +94,12 @@ namespace nosh
             rhs->putScalar(0.0);
           }
 
-          this->add_edge_contributions_(rhs);
-          this->add_vertex_contributions_(rhs);
-          this->add_domain_boundary_contributions_(rhs);
+          this->assemble_local_(rhs);
+
+          if (overlap_matrix_) {
+            this->export_overlap_(rhs);
+          }
+
           this->apply_dbcs_(rhs);
 
           this->fillComplete();
@@ -69,184 +107,428 @@ namespace nosh
           return;
         }
 
+      //! Recomputes the values (and rhs) for the unchanged sparsity pattern.
+      //! The matrix stays fill-complete; the values are overwritten in place.
+      //! (The first call does a full fill().)
+      void
+        refill(
+          const std::shared_ptr<Tpetra::Vector<double,int,int>> & rhs = nullptr
+          )
+        {
+          if (!this->isFillComplete()) {
+            this->fill(rhs);
+            return;
+          }
+
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+          Teuchos::TimeMonitor tm(*fill_time_);
+#endif
+          if (rhs) {
+            rhs->putScalar(0.0);
+          }
+
+          if (overlap_matrix_) {
+            // Tpetra only combines the shared rows into a matrix that is being
+            // filled. Nothing changes off-process though, so skip the global
+            // assembly in fillComplete().
+            this->assemble_local_(rhs);
+            this->resumeFill();
+            this->setAllToScalar(0.0);
+            this->export_overlap_(rhs);
+            this->apply_dbcs_(rhs);
+            auto params = Teuchos::parameterList();
+            params->set("No Nonlocal Changes", true);
+            this->fillComplete(params);
+            return;
+          }
+
+          this->assemble_local_(rhs);
+          this->apply_dbcs_(rhs);
+
+          return;
+        }
+
+    private:
+      //! Zeros the local values and scatters all contributions into the local
+      //! rows (all local vertices) at the positions precomputed by the mesh.
+      //! With ghost vertices, that's the overlap matrix which is added up at
+      //! the owners afterwards.
+      void
+      assemble_local_(
+          const std::shared_ptr<Tpetra::Vector<double,int,int>> & rhs
+          )
+      {
+        Tpetra::CrsMatrix<double,int,int> & local_matrix =
+          overlap_matrix_ ? *overlap_matrix_ : *this;
+        const auto local_rhs = overlap_matrix_ ? overlap_rhs_ : rhs;
+        if (overlap_matrix_) {
+          overlap_rhs_->putScalar(0.0);
+        }
+
+        const auto values = local_matrix.getLocalMatrix().values;
+        Kokkos::deep_copy(values, 0.0);
+        const auto rhs_data = local_rhs ?
+          local_rhs->getDataNonConst() :
+          Teuchos::ArrayRCP<double>();
+
+        this->add_edge_contributions_(values, rhs_data);
+        this->add_vertex_contributions_(values, rhs_data);
+        this->add_domain_boundary_contributions_(values, rhs_data);
+        return;
+      }
+
+      //! Adds the overlap matrix (and rhs) into this matrix (and rhs), which
+      //! must be in fill mode.
+      void
+      export_overlap_(
+          const std::shared_ptr<Tpetra::Vector<double,int,int>> & rhs
+          )
+      {
+        // The overlap matrix is filled only once; its values are always
+        // written in place.
+        if (!overlap_matrix_->isFillComplete()) {
+          overlap_matrix_->fillComplete();
+        }
+        const auto exporter = this->mesh->exporter();
+        this->doExport(*overlap_matrix_, *exporter, Tpetra::ADD);
+        if (rhs) {
+          rhs->doExport(*overlap_rhs_, *exporter, Tpetra::ADD);
+        }
+        return;
+      }
+
     private:
+      typedef Tpetra::CrsMatrix<double,int,int>::local_matrix_type::values_type
+        values_type;
+
+      //! number of edges per matrix_core_edge::eval_batch() call
+      static constexpr int batch_size = 64;
 
       void
       add_edge_contributions_(
-          const std::shared_ptr<Tpetra::Vector<double,int,int>> & rhs
+          const values_type & values,
+          const Teuchos::ArrayRCP<double> & rhs_data
           )
       {
+        const auto & offsets = this->mesh->overlap_crs_offsets().edges;
         for (const auto & matrix_core_edge: this->matrix_core_edges_) {
           for (const auto & subdomain_id: matrix_core_edge->subdomain_ids) {
-            const auto edge_data = this->mesh->get_edge_data();
-
-            // this->meshset interior edges
-            const auto edges = this->mesh->get_edges(subdomain_id);
-            for (const auto edge: edges) {
-              auto vals = matrix_core_edge->eval(edge);
-
-              const auto lid = this->mesh->local_index(edge);
-              const auto & gids = this->mesh->edge_gids[lid];
-              for (int i = 0; i < 2; i++) {
-                // Add to matrix
-                const int num_lhs = this->sumIntoGlobalValues(
-                    gids[i], gids,
-                    Teuchos::ArrayView<double>(vals.lhs[i])
-                    );
-#ifndef NDEBUG
-                TEUCHOS_ASSERT_EQUALITY(num_lhs, 2);
-#endif
-                if (rhs) {
-                  // Add to rhs
-                  rhs->sumIntoGlobalValue(gids[i], vals.rhs[i]);
-                }
-              }
-            }
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
 
-            // this->meshset boundary edges
-            const auto half_edges = this->mesh->get_edges(
-                subdomain_id + "_halfedges"
-                );
-            for (const auto edge: half_edges) {
-              const auto verts = this->mesh->get_vertex_tuple(edge);
-
-              // check which one of the two verts is in this->meshset
-              int i;
-              if (this->mesh->contains(subdomain_id, {verts[0]})) {
-                i = 0;
-              } else if (this->mesh->contains(subdomain_id, {verts[1]})) {
-                i = 1;
-              } else {
-                TEUCHOS_TEST_FOR_EXCEPT_MSG(
-                    true,
-                    "Neither of the two edge vertices is contained in the subdomain."
-                    );
+            const int num_edges = tables.edge_table.size();
+            const auto add_edge = [&](
+                const int k,
+                const double * lhs,
+                const double * rhs
+                ) {
+              const auto & entry = tables.edge_table[k];
+              const auto & o = offsets[entry[0]];
+              // Add to matrix
+              values(o[0]) += lhs[0];
+              values(o[1]) += lhs[1];
+              values(o[2]) += lhs[2];
+              values(o[3]) += lhs[3];
+              if (!rhs_data.is_null()) {
+                // Add to rhs
+                rhs_data[entry[1]] += rhs[0];
+                rhs_data[entry[2]] += rhs[1];
               }
-
-              auto vals = matrix_core_edge->eval(edge);
-
-              const auto lid = this->mesh->local_index(edge);
-              const auto & gids = this->mesh->edge_gids[lid];
+            };
+            // boundary edges; only the row of the inside vertex is touched
+            const auto add_half_edge = [&](
+                const int k,
+                const double * lhs,
+                const double * rhs
+                ) {
+              const auto & entry = tables.half_edge_table[k];
+              const int i = entry[2];
+              const auto & o = offsets[entry[0]];
               // Add to matrix
-              int num_lhs = this->sumIntoGlobalValues(
-                  gids[i], gids,
-                  Teuchos::ArrayView<double>(vals.lhs[i])
-                  );
-#ifndef NDEBUG
-              TEUCHOS_ASSERT_EQUALITY(num_lhs, 2);
-#endif
-              if (rhs) {
+              values(o[2*i]) += lhs[2*i];
+              values(o[2*i + 1]) += lhs[2*i + 1];
+              if (!rhs_data.is_null()) {
                 // Add to rhs
-                rhs->sumIntoGlobalValue(gids[i], vals.rhs[i]);
+                rhs_data[entry[1]] += rhs[i];
+              }
+            };
+
+#ifdef NOSH_THREADED
+            // Edges of one color don't share rows, so they can be added
+            // concurrently.
+            for (size_t c = 0; c + 1 < tables.color_ptrs.size(); c++) {
+              const int begin = tables.color_ptrs[c];
+              const int end = tables.color_ptrs[c+1];
+              const int num_batches = (end - begin + batch_size - 1) / batch_size;
+              nosh::parallel_for(num_batches, [&](const int b) {
+                const int first = begin + b * batch_size;
+                const int n = end - first < batch_size ? end - first : batch_size;
+                std::array<moab::EntityHandle, batch_size> edges;
+                std::array<double, 4*batch_size> lhs;
+                std::array<double, 2*batch_size> rhs;
+                for (int j = 0; j < n; j++) {
+                  const int item = tables.color_items[first + j];
+                  edges[j] = item < num_edges ?
+                    tables.edges[item] :
+                    tables.half_edges[item - num_edges];
+                }
+                matrix_core_edge->eval_batch(edges.data(), n, lhs.data(), rhs.data());
+                for (int j = 0; j < n; j++) {
+                  const int item = tables.color_items[first + j];
+                  if (item < num_edges) {
+                    add_edge(item, &lhs[4*j], &rhs[2*j]);
+                  } else {
+                    add_half_edge(item - num_edges, &lhs[4*j], &rhs[2*j]);
+                  }
+                }
+              });
+            }
+#else
+            std::array<double, 4*batch_size> lhs;
+            std::array<double, 2*batch_size> rhs;
+            // interior edges
+            for (int first = 0; first < num_edges; first += batch_size) {
+              const int n = num_edges - first < batch_size ?
+                num_edges - first : batch_size;
+              matrix_core_edge->eval_batch(
+                  &tables.edges[first], n, lhs.data(), rhs.data()
+                  );
+              for (int j = 0; j < n; j++) {
+                add_edge(first + j, &lhs[4*j], &rhs[2*j]);
+              }
+            }
+            // boundary edges
+            const int num_half_edges = tables.half_edge_table.size();
+            for (int first = 0; first < num_half_edges; first += batch_size) {
+              const int n = num_half_edges - first < batch_size ?
+                num_half_edges - first : batch_size;
+              matrix_core_edge->eval_batch(
+                  &tables.half_edges[first], n, lhs.data(), rhs.data()
+                  );
+              for (int j = 0; j < n; j++) {
+                add_half_edge(first + j, &lhs[4*j], &rhs[2*j]);
               }
             }
+#endif
           }
         }
       }
 
       void
       add_vertex_contributions_(
-          const std::shared_ptr<Tpetra::Vector<double,int,int>> & rhs
+          const values_type & values,
+          const Teuchos::ArrayRCP<double> & rhs_data
           )
       {
+        const auto & diagonals = this->mesh->overlap_crs_offsets().diagonals;
         for (const auto & matrix_core_vertex: this->matrix_core_vertexs_) {
           for (const auto & subdomain_id: matrix_core_vertex->subdomain_ids) {
-            const auto verts = this->mesh->get_vertices(subdomain_id);
-            for (const auto & vertex: verts) {
-              const auto val = matrix_core_vertex->eval(vertex);
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            const int num_vertices = tables.vertices.size();
+            // Every vertex has its own row.
+            nosh::parallel_for(num_vertices, [&](const int k) {
+              const int lid = tables.vertex_lids[k];
+              // only on the owner
+              if (diagonals[lid] == Teuchos::OrdinalTraits<size_t>::invalid()) {
+                return;
+              }
+              const auto val = matrix_core_vertex->eval(tables.vertices[k]);
               // Add to matrix
-              const auto lid = this->mesh->local_index(vertex);
-              const auto gid = this->getMap()->getGlobalElement(lid);
-              const auto num_lhs = this->sumIntoGlobalValues(
-                  gid,
-                  Teuchos::tuple<int>(gid),
-                  Teuchos::tuple<double>(val.lhs)
-                  );
-#ifndef NDEBUG
-              TEUCHOS_ASSERT_EQUALITY(num_lhs, 1);
-#endif
-              if (rhs) {
+              values(diagonals[lid]) += val.lhs;
+              if (!rhs_data.is_null()) {
                 // add to rhs
-                rhs->sumIntoGlobalValue(gid, val.rhs);
+                rhs_data[lid] += val.rhs;
               }
-            }
+            });
           }
         }
       }
 
       void
       add_domain_boundary_contributions_(
-          const std::shared_ptr<Tpetra::Vector<double,int,int>> & rhs
+          const values_type & values,
+          const Teuchos::ArrayRCP<double> & rhs_data
           )
       {
-        const auto surfs = this->mesh->boundary_surface_areas();
-        for (const auto matrix_core_boundary: this->matrix_core_boundarys_) {
+        const auto & diagonals = this->mesh->overlap_crs_offsets().diagonals;
+        for (const auto & matrix_core_boundary: this->matrix_core_boundarys_) {
           for (const auto & subdomain_id: matrix_core_boundary->subdomain_ids) {
-            const auto verts = this->mesh->get_vertices(subdomain_id);
-            for (const auto vert: verts) {
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            const int num_vertices = tables.vertices.size();
+            // Every vertex has its own row.
+            nosh::parallel_for(num_vertices, [&](const int k) {
+              const int lid = tables.vertex_lids[k];
+              // only on the owner
+              if (diagonals[lid] == Teuchos::OrdinalTraits<size_t>::invalid()) {
+                return;
+              }
               // eval
-              const auto val = matrix_core_boundary->eval(vert);
+              const auto val = matrix_core_boundary->eval(tables.vertices[k]);
               // Add to matrix
-              const auto lid = this->mesh->local_index(vert);
-              const auto gid = this->getMap()->getGlobalElement(lid);
-              const auto num_lhs = this->sumIntoGlobalValues(
-                  gid,
-                  Teuchos::tuple<int>(gid),
-                  Teuchos::tuple<double>(val.lhs)
-                  );
-#ifndef NDEBUG
-              TEUCHOS_ASSERT_EQUALITY(num_lhs, 1);
-#endif
-              if (rhs) {
+              values(diagonals[lid]) += val.lhs;
+              if (!rhs_data.is_null()) {
                 // add to rhs
-                rhs->sumIntoGlobalValue(gid, val.rhs);
+                rhs_data[lid] += val.rhs;
               }
+            });
+          }
+        }
+      }
+
+      //! Precomputes the owned Dirichlet rows (with the positions of their
+      //! entries in the local values) and, for symmetric elimination, the mask
+      //! of Dirichlet columns.
+      void
+      build_dirichlet_masks_()
+      {
+        const auto row_ptrs = this->getCrsGraph()->getNodeRowPtrs();
+        const auto cols = this->getCrsGraph()->getNodePackedIndices();
+        const auto row_map = this->getRowMap();
+        const auto col_map = this->getColMap();
+        const auto overlap_map = this->mesh->overlap_map();
+
+        dirichlet_rows_.resize(dbcs_.size());
+        for (size_t b = 0; b < dbcs_.size(); b++) {
+          for (const auto & subdomain_id: dbcs_[b]->subdomain_ids) {
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            for (size_t k = 0; k < tables.vertices.size(); k++) {
+              const int gid = overlap_map->getGlobalElement(tables.vertex_lids[k]);
+              const int row = row_map->getLocalElement(gid);
+              // only on the owner
+              if (row == Teuchos::OrdinalTraits<int>::invalid()) {
+                continue;
+              }
+              const int diagonal_col = col_map->getLocalElement(gid);
+              size_t diagonal = Teuchos::OrdinalTraits<size_t>::invalid();
+              for (size_t i = row_ptrs[row]; i < row_ptrs[row+1]; i++) {
+                if (cols[i] == diagonal_col) {
+                  diagonal = i;
+                  break;
+                }
+              }
+              TEUCHOS_TEST_FOR_EXCEPT_MSG(
+                  diagonal == Teuchos::OrdinalTraits<size_t>::invalid(),
+                  "Matrix has no main diagonal entry."
+                  );
+              dirichlet_rows_[b].push_back(
+                  {row, row_ptrs[row], row_ptrs[row+1], diagonal, tables.vertices[k]}
+                  );
+            }
+          }
+        }
+
+        if (!symmetric_dbcs_) {
+          return;
+        }
+
+        // The owners decide which vertices are Dirichlet vertices; the columns
+        // get that from them. The column map has the columns of all local
+        // rows, ghost vertices of the mesh or not.
+        const auto domain_map = this->getDomainMap();
+        col_importer_ = this->getCrsGraph()->getImporter();
+        if (col_importer_.is_null()) {
+          // The column map is the domain map.
+          col_importer_ = Teuchos::rcp(
+              new Tpetra::Import<int,int>(domain_map, col_map)
+              );
+        }
+
+        Tpetra::Vector<double,int,int> mask(domain_map);
+        {
+          auto mask_data = mask.getDataNonConst();
+          for (const auto & rows: dirichlet_rows_) {
+            for (const auto & r: rows) {
+              mask_data[r.row] = 1.0;
             }
           }
         }
+        Tpetra::Vector<double,int,int> col_mask(col_map);
+        col_mask.doImport(mask, *col_importer_, Tpetra::INSERT);
+        const auto mask_data = col_mask.getData();
+
+        const size_t num_cols = col_map->getNodeNumElements();
+        is_dirichlet_col_.resize(num_cols);
+        for (size_t c = 0; c < num_cols; c++) {
+          is_dirichlet_col_[c] = mask_data[c] != 0.0;
+        }
+        dirichlet_col_values_ =
+          std::make_shared<Tpetra::Vector<double,int,int>>(col_map);
+        return;
       }
 
-      // apply dirichlet boundary conditions
+      //! Sets the Dirichlet rows to identity rows (and the rhs to the
+      //! boundary values) directly in the local values. With symmetric_dbcs_,
+      //! the Dirichlet columns are zeroed too, their contributions moved to
+      //! the rhs.
       void
       apply_dbcs_(
           const std::shared_ptr<Tpetra::Vector<double,int,int>> & rhs
           )
       {
-        for (const auto & bc: this->dbcs_) {
-          for (const auto & subdomain_id: bc->subdomain_ids) {
-            const auto verts = this->mesh->get_vertices(subdomain_id);
-            for (const auto & vertex: verts) {
-              // eliminate the row in A
-              auto gid = this->mesh->gid(vertex);
-              size_t num = this->getNumEntriesInGlobalRow(gid);
-              // It shouldn't actually happen that the specified global row
-              // does not belong to this graph.
-              // TODO(nschloe): find out if why we need this, fix the underlying issue,
-              // make this a TEUCHOS_TEST_*
-              if (num != Teuchos::OrdinalTraits<size_t>::invalid()) {
-                std::vector<int> cols(num);
-                std::vector<double> vals(num);
-                this->getGlobalRowCopy(gid, cols, vals, num);
-                // set vals to 0
-                std::fill(vals.begin(), vals.end(), 0.0);
-                // set diagonal entry to 1
-                auto it = std::find(cols.begin(), cols.end(), gid);
-                TEUCHOS_TEST_FOR_EXCEPT_MSG(
-                    it == cols.end(),
-                    "Matrix has no main diagonal entry."
-                    );
-                int pos = it - cols.begin();
-                // set diagonal entry to 1
-                vals[pos] = 1.0;
-                this->replaceGlobalValues(gid, cols, vals);
-              }
-              if (rhs) {
-                // set rhs
-                rhs->replaceGlobalValue(gid, bc->eval(vertex));
-              }
+        const auto values = this->getLocalMatrix().values;
+        const auto rhs_data = rhs ?
+          rhs->getDataNonConst() :
+          Teuchos::ArrayRCP<double>();
+
+        if (symmetric_dbcs_) {
+          this->eliminate_dirichlet_cols_(values, rhs_data);
+        }
+
+        for (size_t b = 0; b < dbcs_.size(); b++) {
+          const auto & bc = dbcs_[b];
+          const auto & rows = dirichlet_rows_[b];
+          const int num_rows = rows.size();
+          nosh::parallel_for(num_rows, [&](const int k) {
+            const auto & r = rows[k];
+            // eliminate the row in A, set diagonal entry to 1
+            for (size_t i = r.begin; i < r.end; i++) {
+              values(i) = 0.0;
+            }
+            values(r.diagonal) = 1.0;
+            if (!rhs_data.is_null()) {
+              // set rhs
+              rhs_data[r.row] = bc->eval(r.vertex);
+            }
+          });
+        }
+        return;
+      }
+
+      void
+      eliminate_dirichlet_cols_(
+          const values_type & values,
+          const Teuchos::ArrayRCP<double> & rhs_data
+          )
+      {
+        // Boundary values at the owners, distributed to the columns
+        dirichlet_values_->putScalar(0.0);
+        {
+          auto g = dirichlet_values_->getDataNonConst();
+          for (size_t b = 0; b < dbcs_.size(); b++) {
+            for (const auto & r: dirichlet_rows_[b]) {
+              g[r.row] = dbcs_[b]->eval(r.vertex);
             }
           }
         }
+        dirichlet_col_values_->doImport(
+            *dirichlet_values_, *col_importer_, Tpetra::INSERT
+            );
+        const auto g = dirichlet_col_values_->getData();
+
+        // Dirichlet rows are overwritten afterwards, so go over all rows.
+        const auto row_ptrs = this->getCrsGraph()->getNodeRowPtrs();
+        const auto cols = this->getCrsGraph()->getNodePackedIndices();
+        const int num_rows = this->getNodeNumRows();
+        nosh::parallel_for(num_rows, [&](const int row) {
+          for (size_t i = row_ptrs[row]; i < row_ptrs[row+1]; i++) {
+            if (is_dirichlet_col_[cols[i]]) {
+              if (!rhs_data.is_null()) {
+                rhs_data[row] -= values(i) * g[cols[i]];
+              }
+              values(i) = 0.0;
+            }
+          }
+        });
+        return;
       }
 
     public:
@@ -260,6 +542,30 @@ namespace nosh
       const std::vector<std::shared_ptr<const matrix_core_vertex>> matrix_core_vertexs_;
       const std::vector<std::shared_ptr<const matrix_core_boundary>> matrix_core_boundarys_;
       const std::vector<std::shared_ptr<const nosh::matrix_core_dirichlet>> dbcs_;
+      //! Local assembly target if there are ghost vertices, otherwise null.
+      const std::shared_ptr<Tpetra::CrsMatrix<double,int,int>> overlap_matrix_;
+      const std::shared_ptr<Tpetra::Vector<double,int,int>> overlap_rhs_;
+
+      //! Whether to eliminate the Dirichlet columns, too, keeping the matrix
+      //! symmetric.
+      const bool symmetric_dbcs_;
+      struct dirichlet_row {
+        int row;
+        //! positions of the row's entries, and of its diagonal entry, in the
+        //! local values
+        size_t begin;
+        size_t end;
+        size_t diagonal;
+        moab::EntityHandle vertex;
+      };
+      //! owned Dirichlet rows, for each of dbcs_
+      std::vector<std::vector<dirichlet_row>> dirichlet_rows_;
+      //! Dirichlet mask over the column map (only with symmetric_dbcs_)
+      std::vector<char> is_dirichlet_col_;
+      //! boundary values at the owned vertices, and over the column map
+      const std::shared_ptr<Tpetra::Vector<double,int,int>> dirichlet_values_;
+      Teuchos::RCP<const Tpetra::Import<int,int>> col_importer_;
+      std::shared_ptr<Tpetra::Vector<double,int,int>> dirichlet_col_values_;
   };
 } // namespace nosh
 
@@ -1,7 +1,12 @@
 #ifndef NOSH_FVM_OPERATOR_H
 #define NOSH_FVM_OPERATOR_H
 
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include <Teuchos_RCPStdSharedPtrConversions.hpp>
 #include <Tpetra_MultiVector.hpp>
@@ -12,6 +17,7 @@
 #include "operator_core_dirichlet.hpp"
 #include "operator_core_edge.hpp"
 #include "operator_core_vertex.hpp"
+#include "parallel_for.hpp"
 #include "parameter_object.hpp"
 
 namespace nosh
@@ -36,8 +42,23 @@ namespace nosh
       vertex_cores_(std::move(vertex_cores)),
       boundary_cores_(std::move(boundary_cores)),
       dirichlets_(std::move(dirichlets)),
-      operators_(std::move(operators))
+      operators_(std::move(operators)),
+      edge_splits_(),
+      owned_vertices_(),
+      num_dirichlet_rows_(0),
+      is_distributed_(mesh->is_distributed()),
+      owned_lids_(),
+      all_lids_(),
+      ghost_lids_(),
+      has_eval_multi_(false),
+      x_overlap_(),
+      y_overlap_(),
+      y_export_(),
+      x_rows_(),
+      y_rows_(),
+      dirichlet_y_()
       {
+        this->build_splits_();
       }
 
       ~fvm_operator() override = default;
@@ -63,31 +84,141 @@ namespace nosh
             mode != Teuchos::NO_TRANS,
             "Only untransposed applies supported."
             );
-        TEUCHOS_TEST_FOR_EXCEPT_MSG(
-            alpha != 1.0,
-            "Only alpha==1.0 supported."
-            );
-        TEUCHOS_TEST_FOR_EXCEPT_MSG(
-            beta != 0.0,
-            "Only beta==0.0 supported."
-            );
-        y.putScalar(0.0);
 
-        auto yk = Tpetra::MultiVector<double,int,int>(y, Teuchos::Copy);
+        // y = alpha * A(x) + beta * y
+        if (alpha == 0.0) {
+          // As in BLAS, beta == 0 clears y, even of NaNs.
+          if (beta == 0.0) {
+            y.putScalar(0.0);
+          } else {
+            y.scale(beta);
+          }
+          return;
+        }
+
+        // The Dirichlet conditions override their rows at the end; remember
+        // what beta * y contributes there.
+        dirichlet_y_.clear();
+        if (beta != 0.0) {
+          dirichlet_y_.resize(y.getNumVectors() * num_dirichlet_rows_);
+          for (size_t j = 0; j < y.getNumVectors(); j++) {
+            const auto y_data = y.getData(j);
+            double * saved = &dirichlet_y_[j * num_dirichlet_rows_];
+            this->for_each_dirichlet_row_([&](
+                  const operator_core_dirichlet &,
+                  const moab::EntityHandle &,
+                  const int row,
+                  const int m
+                  ) {
+              saved[m] = beta * y_data[row];
+            });
+          }
+        }
+
+        // The wrapped operators accumulate into y directly.
+        double beta_k = beta;
         for (const auto & op: this->operators_) {
-          op->apply(x, yk);
-          y.update(1.0, yk, 1.0);
+          op->apply(x, y, Teuchos::NO_TRANS, alpha, beta_k);
+          beta_k = 1.0;
+        }
+        if (this->operators_.empty()) {
+          if (beta == 0.0) {
+            y.putScalar(0.0);
+          } else if (beta != 1.0) {
+            y.scale(beta);
+          }
+        }
+
+        // The cores work on local (overlap) vertex IDs. With more than one
+        // process, the ghost values of x are imported into x_overlap_ while
+        // the edges between owned vertices are processed, and the
+        // contributions collected in y_overlap_ are added up at the owners.
+        // The export replaces the owned entries of its target, so it goes
+        // to y_export_ first and is then added to y.
+        Teuchos::RCP<const Tpetra::MultiVector<double,int,int>> xo =
+          Teuchos::rcpFromRef(x);
+        Teuchos::RCP<Tpetra::MultiVector<double,int,int>> yo =
+          Teuchos::rcpFromRef(y);
+        if (this->is_distributed_) {
+          if (x_overlap_.is_null()
+              || x_overlap_->getNumVectors() != x.getNumVectors()) {
+            const auto overlap_map = Teuchos::rcp(this->mesh->overlap_map());
+            x_overlap_ = Teuchos::rcp(new Tpetra::MultiVector<double,int,int>(
+                  overlap_map, x.getNumVectors()
+                  ));
+            y_overlap_ = Teuchos::rcp(new Tpetra::MultiVector<double,int,int>(
+                  overlap_map, x.getNumVectors()
+                  ));
+            y_export_ = Teuchos::rcp(new Tpetra::MultiVector<double,int,int>(
+                  Teuchos::rcp(this->mesh->map()), x.getNumVectors()
+                  ));
+          }
+          // beginImport() already copies the values that are local to this
+          // process, i.e., all values the interior edges need.
+          x_overlap_->beginImport(x, *this->mesh->importer(), Tpetra::INSERT);
+          y_overlap_->putScalar(0.0);
+          xo = x_overlap_;
+          yo = y_overlap_;
+        }
+
+        // With several vectors, visit every edge and vertex only once and
+        // update all vectors from a row-major (vertex x vector) copy.
+        const int num_vectors = x.getNumVectors();
+        const bool blocked = num_vectors > 1 && this->has_eval_multi_;
+
+        if (blocked) {
+          this->pack_rows_(*xo, this->all_lids_);
+          y_rows_.assign(num_vectors * this->owned_lids_.size(), 0.0);
+          this->apply_edge_contributions_multi_(num_vectors, true);
+        } else {
+          for (int j = 0; j < num_vectors; j++) {
+            const auto x_data = xo->getData(j);
+            auto y_data = yo->getDataNonConst(j);
+            this->apply_edge_contributions_(x_data, y_data, true, alpha);
+          }
+        }
+
+        if (this->is_distributed_) {
+          x_overlap_->endImport(x, *this->mesh->importer(), Tpetra::INSERT);
+        }
+
+        if (blocked) {
+          this->pack_rows_(*xo, this->ghost_lids_);
+          this->apply_edge_contributions_multi_(num_vectors, false);
+          this->apply_vertex_contributions_multi_(num_vectors);
+          this->unpack_rows_(alpha, *yo);
+        } else {
+          for (int j = 0; j < num_vectors; j++) {
+            const auto x_data = xo->getData(j);
+            auto y_data = yo->getDataNonConst(j);
+            this->apply_edge_contributions_(x_data, y_data, false, alpha);
+            this->apply_vertex_contributions_(x_data, y_data, alpha);
+            this->apply_domain_boundary_contributions_(x_data, y_data, alpha);
+          }
+        }
+
+        if (this->is_distributed_) {
+          y_export_->putScalar(0.0);
+          y_export_->doExport(*y_overlap_, *this->mesh->exporter(), Tpetra::ADD);
+          y.update(1.0, *y_export_, 1.0);
         }
 
+        // Dirichlet comes at the end, overriding everything.
         for (size_t j = 0; j < x.getNumVectors(); j++) {
-          const auto x_data = x.getData(j);
+          const auto x_data = xo->getData(j);
           auto y_data = y.getDataNonConst(j);
-
-          this->apply_edge_contributions_(x_data, y_data);
-          this->apply_vertex_contributions_(x_data, y_data);
-          this->apply_domain_boundary_contributions_(x_data, y_data);
-          // Dirichlet comes at the end, overriding everything.
-          this->apply_dirichlets_(x_data, y_data);
+          const double * saved = dirichlet_y_.empty() ?
+            nullptr :
+            &dirichlet_y_[j * num_dirichlet_rows_];
+          this->for_each_dirichlet_row_([&](
+                const operator_core_dirichlet & bc,
+                const moab::EntityHandle & vertex,
+                const int row,
+                const int m
+                ) {
+            y_data[row] = alpha * bc.eval(vertex, x_data)
+              + (saved == nullptr ? 0.0 : saved[m]);
+          });
         }
 
         return;
@@ -106,103 +237,416 @@ namespace nosh
       }
 
     protected:
+      //! Subdomain edges (indices into the subdomain tables) split by
+      //! whether both vertices are owned by this process or not.
+      struct edge_split {
+        std::vector<int> edges[2];
+        std::vector<int> half_edges[2];
+#ifdef NOSH_THREADED
+        //! The edges (k) and half edges (num_edges + k) of each part grouped
+        //! into the colors of the subdomain tables.
+        std::vector<int> color_ptrs[2];
+        std::vector<int> color_items[2];
+#endif
+      };
+
+      void
+      build_splits_()
+      {
+        const auto map = this->mesh->map();
+        const auto overlap_map = this->mesh->overlap_map();
+        const int num_vertices = overlap_map->getNodeNumElements();
+        owned_lids_.resize(num_vertices);
+        for (int i = 0; i < num_vertices; i++) {
+          // invalid (-1) for ghost vertices
+          owned_lids_[i] = map->getLocalElement(overlap_map->getGlobalElement(i));
+        }
+
+        const auto is_owned = [&](const int lid) {
+          return owned_lids_[lid] >= 0;
+        };
+
+        for (const auto & core: this->edge_cores_) {
+          for (const auto & subdomain_id: core->subdomain_ids) {
+            if (edge_splits_.count(subdomain_id) > 0) {
+              continue;
+            }
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            auto & split = edge_splits_[subdomain_id];
+            const int num_edges = tables.edge_table.size();
+            std::vector<int> item_parts;
+            for (int k = 0; k < num_edges; k++) {
+              const auto & e = tables.edge_table[k];
+              const bool interior = is_owned(e[1]) && is_owned(e[2]);
+              split.edges[interior ? 0 : 1].push_back(k);
+              item_parts.push_back(interior ? 0 : 1);
+            }
+            for (size_t k = 0; k < tables.half_edge_table.size(); k++) {
+              const int lid = tables.half_edge_table[k][0];
+              const auto & vlids = this->mesh->edge_lids[lid];
+              const bool interior = is_owned(vlids[0]) && is_owned(vlids[1]);
+              split.half_edges[interior ? 0 : 1].push_back(k);
+              item_parts.push_back(interior ? 0 : 1);
+            }
+#ifdef NOSH_THREADED
+            // A subset of a color is still conflict-free.
+            for (int part = 0; part < 2; part++) {
+              split.color_ptrs[part].push_back(0);
+            }
+            for (size_t c = 0; c + 1 < tables.color_ptrs.size(); c++) {
+              for (int i = tables.color_ptrs[c]; i < tables.color_ptrs[c+1]; i++) {
+                const int item = tables.color_items[i];
+                split.color_items[item_parts[item]].push_back(item);
+              }
+              for (int part = 0; part < 2; part++) {
+                split.color_ptrs[part].push_back(split.color_items[part].size());
+              }
+            }
+#endif
+          }
+        }
+
+        for (int i = 0; i < num_vertices; i++) {
+          all_lids_.push_back(i);
+          if (!is_owned(i)) {
+            ghost_lids_.push_back(i);
+          }
+        }
+
+        has_eval_multi_ = true;
+        for (const auto & core: this->edge_cores_) {
+          has_eval_multi_ = has_eval_multi_ && core->has_eval_multi();
+        }
+        for (const auto & core: this->vertex_cores_) {
+          has_eval_multi_ = has_eval_multi_ && core->has_eval_multi();
+        }
+        for (const auto & core: this->boundary_cores_) {
+          has_eval_multi_ = has_eval_multi_ && core->has_eval_multi();
+        }
+
+        // Vertex contributions are only added on the owners; the others would
+        // add them again in the export.
+        std::set<std::string> vertex_subdomain_ids;
+        for (const auto & core: this->vertex_cores_) {
+          vertex_subdomain_ids.insert(
+              core->subdomain_ids.begin(), core->subdomain_ids.end()
+              );
+        }
+        for (const auto & core: this->boundary_cores_) {
+          vertex_subdomain_ids.insert(
+              core->subdomain_ids.begin(), core->subdomain_ids.end()
+              );
+        }
+        for (const auto & bc: this->dirichlets_) {
+          vertex_subdomain_ids.insert(
+              bc->subdomain_ids.begin(), bc->subdomain_ids.end()
+              );
+        }
+        for (const auto & subdomain_id: vertex_subdomain_ids) {
+          const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+          auto & owned = owned_vertices_[subdomain_id];
+          for (size_t k = 0; k < tables.vertex_lids.size(); k++) {
+            if (is_owned(tables.vertex_lids[k])) {
+              owned.push_back(k);
+            }
+          }
+        }
+
+        for (const auto & bc: this->dirichlets_) {
+          for (const auto & subdomain_id: bc->subdomain_ids) {
+            num_dirichlet_rows_ += owned_vertices_.at(subdomain_id).size();
+          }
+        }
+
+        return;
+      }
+
+      //! Edge contributions of either the edges between owned vertices
+      //! (interior) or the others. (Overridden by static_fvm_operator with
+      //! loops over the concrete core types.)
+      virtual
       void
       apply_edge_contributions_(
           const Teuchos::ArrayRCP<const double> & x_data,
-          const Teuchos::ArrayRCP<double> & y_data
+          const Teuchos::ArrayRCP<double> & y_data,
+          const bool interior,
+          const double alpha
           ) const
       {
+        const int part = interior ? 0 : 1;
         for (const auto & core: this->edge_cores_) {
           for (const auto & subdomain_id: core->subdomain_ids) {
-            const auto edge_data = this->mesh->get_edge_data();
-            // this->meshset interior edges
-            const auto edges = this->mesh->get_edges(subdomain_id);
-            for (const auto edge: edges) {
-              auto vals = core->eval(edge, x_data);
-
-              const auto verts = this->mesh->get_vertex_tuple(edge);
-              const auto i0 = this->mesh->local_index(verts[0]);
-              const auto i1 = this->mesh->local_index(verts[1]);
-              y_data[i0] += std::get<0>(vals);
-              y_data[i1] += std::get<1>(vals);
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            const auto & edge_table = tables.edge_table;
+            const auto & half_edge_table = tables.half_edge_table;
+            this->for_each_split_edge_(
+                tables, this->edge_splits_.at(subdomain_id), part,
+                // edges inside the subdomain
+                [&](const int k) {
+                  const auto vals = core->eval(tables.edges[k], x_data);
+                  y_data[edge_table[k][1]] += alpha * std::get<0>(vals);
+                  y_data[edge_table[k][2]] += alpha * std::get<1>(vals);
+                },
+                // boundary edges; only the inside vertex gets a contribution
+                [&](const int k) {
+                  const auto vals = core->eval(tables.half_edges[k], x_data);
+                  y_data[half_edge_table[k][1]] += alpha * (
+                      (half_edge_table[k][2] == 0) ?
+                      std::get<0>(vals) :
+                      std::get<1>(vals)
+                      );
+                });
+          }
+        }
+      }
+
+      //! Calls edge(k) for the edges and half_edge(k) for the half edges
+      //! (indices into tables) in part of split. With threads, that's done
+      //! color by color, the edges of one color concurrently, so the
+      //! functions may add to the rows of their edge without locking.
+      template<typename E, typename H>
+      void
+      for_each_split_edge_(
+          const nosh::mesh::subdomain_tables & tables,
+          const edge_split & split,
+          const int part,
+          const E & edge,
+          const H & half_edge
+          ) const
+      {
+#ifdef NOSH_THREADED
+        const int num_edges = tables.edge_table.size();
+        const auto & ptrs = split.color_ptrs[part];
+        const auto & items = split.color_items[part];
+        for (size_t c = 0; c + 1 < ptrs.size(); c++) {
+          const int begin = ptrs[c];
+          nosh::parallel_for(ptrs[c+1] - begin, [&](const int i) {
+            const int item = items[begin + i];
+            if (item < num_edges) {
+              edge(item);
+            } else {
+              half_edge(item - num_edges);
             }
+          });
+        }
+#else
+        (void) tables;
+        for (const int k: split.edges[part]) {
+          edge(k);
+        }
+        for (const int k: split.half_edges[part]) {
+          half_edge(k);
+        }
+#endif
+        return;
+      }
 
-            // this->meshset boundary edges
-            const auto half_edges = this->mesh->get_edges(
-                subdomain_id + "_halfedges"
-                );
-            for (const auto edge: half_edges) {
-              auto vals = core->eval(edge, x_data);
-
-              const auto verts = this->mesh->get_vertex_tuple(edge);
-              // check which one of the two verts is in this->meshset
-              if (this->mesh->contains(subdomain_id, {verts[0]})) {
-                const auto i0 = this->mesh->local_index(verts[0]);
-                y_data[i0] += std::get<0>(vals);
-              } else if (this->mesh->contains(subdomain_id, {verts[1]})) {
-                const auto i1 = this->mesh->local_index(verts[1]);
-                y_data[i1] += std::get<1>(vals);
-              } else {
-                TEUCHOS_TEST_FOR_EXCEPT_MSG(
-                    true,
-                    "Neither of the two edge vertices is contained in the subdomain."
-                    );
-              }
+      //! Calls f(i, k) for the owned vertices k (indices into the subdomain
+      //! tables) of subdomain_id, i counting them; concurrently with threads.
+      template<typename F>
+      void
+      for_each_owned_vertex_(const std::string & subdomain_id, const F & f) const
+      {
+        const auto & owned = this->owned_vertices_.at(subdomain_id);
+        const int n = owned.size();
+        nosh::parallel_for(n, [&](const int i) {
+          f(i, owned[i]);
+        });
+        return;
+      }
+
+      //! Copies the entries lids of the columns of x into x_rows_.
+      void
+      pack_rows_(
+          const Tpetra::MultiVector<double,int,int> & x,
+          const std::vector<int> & lids
+          ) const
+      {
+        const int num_vectors = x.getNumVectors();
+        x_rows_.resize(num_vectors * this->owned_lids_.size());
+        std::vector<Teuchos::ArrayRCP<const double>> x_data(num_vectors);
+        for (int j = 0; j < num_vectors; j++) {
+          x_data[j] = x.getData(j);
+        }
+        const int n = lids.size();
+        nosh::parallel_for(n, [&](const int m) {
+          const int i = lids[m];
+          for (int j = 0; j < num_vectors; j++) {
+            x_rows_[num_vectors*i + j] = x_data[j][i];
+          }
+        });
+      }
+
+      //! Adds alpha * y_rows_ to the columns of y.
+      void
+      unpack_rows_(
+          const double alpha,
+          Tpetra::MultiVector<double,int,int> & y
+          ) const
+      {
+        const int num_vectors = y.getNumVectors();
+        std::vector<Teuchos::ArrayRCP<double>> y_data(num_vectors);
+        for (int j = 0; j < num_vectors; j++) {
+          y_data[j] = y.getDataNonConst(j);
+        }
+        const int n = y.getLocalLength();
+        nosh::parallel_for(n, [&](const int i) {
+          for (int j = 0; j < num_vectors; j++) {
+            y_data[j][i] += alpha * y_rows_[num_vectors*i + j];
+          }
+        });
+      }
+
+      //! Work space of n doubles for the calling thread, for the results of
+      //! eval_multi() in the blocked kernels.
+      static
+      double *
+      thread_scratch_(const int n)
+      {
+        static thread_local std::vector<double> scratch;
+        if (scratch.size() < static_cast<size_t>(n)) {
+          scratch.resize(n);
+        }
+        return scratch.data();
+      }
+
+      //! Same as apply_edge_contributions_(), for all vectors in x_rows_ at
+      //! once. With threads, that's color by color, too.
+      void
+      apply_edge_contributions_multi_(
+          const int num_vectors,
+          const bool interior
+          ) const
+      {
+        const int part = interior ? 0 : 1;
+        const double * u = x_rows_.data();
+        for (const auto & core: this->edge_cores_) {
+          for (const auto & subdomain_id: core->subdomain_ids) {
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            const auto & edge_table = tables.edge_table;
+            const auto & half_edge_table = tables.half_edge_table;
+            this->for_each_split_edge_(
+                tables, this->edge_splits_.at(subdomain_id), part,
+                [&](const int k) {
+                  double * vals0 = thread_scratch_(2 * num_vectors);
+                  double * vals1 = vals0 + num_vectors;
+                  core->eval_multi(tables.edges[k], u, num_vectors, vals0, vals1);
+                  double * y0 = &y_rows_[num_vectors * edge_table[k][1]];
+                  double * y1 = &y_rows_[num_vectors * edge_table[k][2]];
+                  for (int j = 0; j < num_vectors; j++) {
+                    y0[j] += vals0[j];
+                    y1[j] += vals1[j];
+                  }
+                },
+                [&](const int k) {
+                  double * vals0 = thread_scratch_(2 * num_vectors);
+                  double * vals1 = vals0 + num_vectors;
+                  core->eval_multi(
+                      tables.half_edges[k], u, num_vectors, vals0, vals1
+                      );
+                  const double * vals =
+                    (half_edge_table[k][2] == 0) ? vals0 : vals1;
+                  double * y0 = &y_rows_[num_vectors * half_edge_table[k][1]];
+                  for (int j = 0; j < num_vectors; j++) {
+                    y0[j] += vals[j];
+                  }
+                });
+          }
+        }
+      }
+
+      //! Vertex and domain boundary contributions for all vectors in x_rows_
+      //! at once.
+      void
+      apply_vertex_contributions_multi_(const int num_vectors) const
+      {
+        const double * u = x_rows_.data();
+        const auto add = [&](
+            const std::string & subdomain_id,
+            const std::function<void(moab::EntityHandle, double*)> & eval
+            ) {
+          const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+          this->for_each_owned_vertex_(subdomain_id, [&](const int, const int k) {
+            double * vals = thread_scratch_(num_vectors);
+            eval(tables.vertices[k], vals);
+            double * y0 = &y_rows_[num_vectors * tables.vertex_lids[k]];
+            for (int j = 0; j < num_vectors; j++) {
+              y0[j] += vals[j];
             }
+          });
+        };
+        for (const auto & core: this->vertex_cores_) {
+          for (const auto & subdomain_id: core->subdomain_ids) {
+            add(subdomain_id, [&](const moab::EntityHandle vertex, double * vals) {
+              core->eval_multi(vertex, u, num_vectors, vals);
+            });
+          }
+        }
+        for (const auto & core: this->boundary_cores_) {
+          for (const auto & subdomain_id: core->subdomain_ids) {
+            add(subdomain_id, [&](const moab::EntityHandle vertex, double * vals) {
+              core->eval_multi(vertex, u, num_vectors, vals);
+            });
           }
         }
       }
 
+      virtual
       void
       apply_vertex_contributions_(
           const Teuchos::ArrayRCP<const double> & x_data,
-          const Teuchos::ArrayRCP<double> & y_data
+          const Teuchos::ArrayRCP<double> & y_data,
+          const double alpha
           ) const
       {
-        const auto & control_volumes = this->mesh->control_volumes();
-        const auto c_data = control_volumes->getData();
         for (const auto & core: this->vertex_cores_) {
           for (const auto & subdomain_id: core->subdomain_ids) {
-            const auto verts = this->mesh->get_vertices(subdomain_id);
-            for (const auto & vertex: verts) {
-              const auto k = this->mesh->local_index(vertex);
-              y_data[k] += core->eval(vertex, x_data);
-            }
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            this->for_each_owned_vertex_(subdomain_id, [&](const int, const int k) {
+              y_data[tables.vertex_lids[k]] +=
+                alpha * core->eval(tables.vertices[k], x_data);
+            });
           }
         }
       }
 
+      virtual
       void
       apply_domain_boundary_contributions_(
           const Teuchos::ArrayRCP<const double> & x_data,
-          const Teuchos::ArrayRCP<double> & y_data
+          const Teuchos::ArrayRCP<double> & y_data,
+          const double alpha
           ) const
       {
-        const auto surfs = this->mesh->boundary_surface_areas();
-        for (const auto core: this->boundary_cores_) {
+        for (const auto & core: this->boundary_cores_) {
           for (const auto & subdomain_id: core->subdomain_ids) {
-            const auto verts = this->mesh->get_vertices(subdomain_id);
-            for (const auto vert: verts) {
-              const auto k = this->mesh->local_index(vert);
-              y_data[k] += core->eval(vert, x_data);
-            }
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            this->for_each_owned_vertex_(subdomain_id, [&](const int, const int k) {
+              y_data[tables.vertex_lids[k]] +=
+                alpha * core->eval(tables.vertices[k], x_data);
+            });
           }
         }
       }
 
+      //! Calls f(bc, vertex, row, m) for the owned vertices of all Dirichlet
+      //! conditions, row being the vertex' local ID in the owned map and m
+      //! counting the calls (0, ..., num_dirichlet_rows_ - 1).
+      template<typename F>
       void
-      apply_dirichlets_(
-          const Teuchos::ArrayRCP<const double> & x_data,
-          const Teuchos::ArrayRCP<double> & y_data
-          ) const
+      for_each_dirichlet_row_(const F & f) const
       {
+        int m = 0;
         for (const auto & bc: this->dirichlets_) {
           for (const auto & subdomain_id: bc->subdomain_ids) {
-            const auto verts = this->mesh->get_vertices(subdomain_id);
-            for (const auto & vertex: verts) {
-              const auto k = this->mesh->local_index(vertex);
-              y_data[k] = bc->eval(vertex, x_data);
-            }
+            const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+            this->for_each_owned_vertex_(subdomain_id, [&](const int i, const int k) {
+              f(
+                  *bc, tables.vertices[k],
+                  this->owned_lids_[tables.vertex_lids[k]], m + i
+                  );
+            });
+            m += this->owned_vertices_.at(subdomain_id).size();
           }
         }
       }
@@ -219,6 +663,28 @@ namespace nosh
       const std::vector<std::shared_ptr<operator_core_boundary>> boundary_cores_;
       const std::vector<std::shared_ptr<operator_core_dirichlet>> dirichlets_;
       const std::vector<std::shared_ptr<Tpetra::Operator<double,int,int>>> operators_;
+
+      std::map<std::string, edge_split> edge_splits_;
+      //! Indices of the owned vertices in the subdomain tables.
+      std::map<std::string, std::vector<int>> owned_vertices_;
+      //! number of for_each_dirichlet_row_() calls per vector
+      int num_dirichlet_rows_;
+
+    private:
+      const bool is_distributed_;
+      //! Local vertex ID -> local ID in the owned map (-1 for ghosts).
+      std::vector<int> owned_lids_;
+      std::vector<int> all_lids_;
+      std::vector<int> ghost_lids_;
+      bool has_eval_multi_;
+      mutable Teuchos::RCP<Tpetra::MultiVector<double,int,int>> x_overlap_;
+      mutable Teuchos::RCP<Tpetra::MultiVector<double,int,int>> y_overlap_;
+      mutable Teuchos::RCP<Tpetra::MultiVector<double,int,int>> y_export_;
+      //! Row-major (vertex x vector) work arrays of the blocked apply.
+      mutable std::vector<double> x_rows_;
+      mutable std::vector<double> y_rows_;
+      //! beta * y at the Dirichlet rows, saved during apply()
+      mutable std::vector<double> dirichlet_y_;
   };
 } // namespace nosh
 
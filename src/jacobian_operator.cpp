@@ -7,9 +7,9 @@
 #include <Tpetra_Vector.hpp>
 #include <Teuchos_RCPStdSharedPtrConversions.hpp>
 
-#include "parameter_matrix_keo.hpp"
 #include "mesh.hpp"
 #include "scalar_field_base.hpp"
+#include "vector_pool.hpp"
 
 namespace nosh
 {
@@ -19,15 +19,20 @@ jacobian_operator(
     const std::shared_ptr<const nosh::mesh> &mesh,
     const std::shared_ptr<const nosh::scalar_field::base> &scalar_potential,
     const std::shared_ptr<const nosh::scalar_field::base> &thickness,
-    const std::shared_ptr<nosh::parameter_matrix::keo> &keo
+    const std::shared_ptr<nosh::parameter_object> &keo
     ) :
   mesh_(mesh),
   scalar_potential_(scalar_potential),
   thickness_(thickness),
   keo_(keo),
+  keo_op_(std::dynamic_pointer_cast<const Tpetra::Operator<double,int,int>>(keo)),
   diag0_(Teuchos::rcp(mesh->complex_map())),
   diag1b_(mesh->control_volumes()->getMap())
 {
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      !keo_op_,
+      "The kinetic energy operator must be a Tpetra::Operator."
+      );
 }
 // =============================================================================
 jacobian_operator::
@@ -62,7 +67,7 @@ apply(
   // B = g * diag(thickness * psi^2)
 
   // Y = K*X
-  keo_->apply(X, Y);
+  keo_op_->apply(X, Y);
 
   const int num_my_points = mesh_->control_volumes()->getLocalLength();
 #ifndef NDEBUG
@@ -155,22 +160,19 @@ rebuild_diags_(
 
   const double g = params.at("g");
 
-  const auto thickness_values = thickness_->get_v(params);
-#ifndef NDEBUG
-  TEUCHOS_ASSERT(control_volumes.getMap()->isSameAs(*thickness_values.getMap()));
-#endif
+  // borrowed work vectors, on the map of the control volumes
+  const auto thickness_values =
+    vector_pool::global().get(control_volumes.getMap());
+  thickness_->fill_v(params, *thickness_values);
 
-  const auto scalar_potential_values = scalar_potential_->get_v(params);
-#ifndef NDEBUG
-  TEUCHOS_ASSERT(
-      control_volumes.getMap()->isSameAs(*scalar_potential_values.getMap())
-      );
-#endif
+  const auto scalar_potential_values =
+    vector_pool::global().get(control_volumes.getMap());
+  scalar_potential_->fill_v(params, *scalar_potential_values);
 
   auto x_data = x.getData();
   auto c_data = control_volumes.getData();
-  auto t_data = thickness_values.getData();
-  auto s_data = scalar_potential_values.getData();
+  auto t_data = thickness_values->getData();
+  auto s_data = scalar_potential_values->getData();
 
   auto d0_data = diag0_.getDataNonConst();
   auto d1b_data = diag1b_.getDataNonConst();
@@ -8,7 +8,7 @@
 #include <Tpetra_Operator.hpp>
 #include <Teuchos_RCP.hpp>
 
-#include "parameter_matrix_keo.hpp"
+#include "parameter_object.hpp"
 
 // forward declarations
 namespace nosh
@@ -30,7 +30,7 @@ public:
       const std::shared_ptr<const nosh::mesh> &mesh,
       const std::shared_ptr<const nosh::scalar_field::base> &scalar_potential,
       const std::shared_ptr<const nosh::scalar_field::base> &thickness,
-      const std::shared_ptr<nosh::parameter_matrix::keo> &keo
+      const std::shared_ptr<nosh::parameter_object> &keo
       );
 
   // Destructor.
@@ -48,13 +48,13 @@ public:
   virtual
   Teuchos::RCP<const Tpetra::Map<int,int>> getDomainMap() const
   {
-    return keo_->getDomainMap();
+    return keo_op_->getDomainMap();
   }
 
   virtual
   Teuchos::RCP<const Tpetra::Map<int,int>> getRangeMap() const
   {
-    return keo_->getRangeMap();
+    return keo_op_->getRangeMap();
   }
 
 public:
@@ -77,7 +77,11 @@ private:
   const std::shared_ptr<const nosh::scalar_field::base> scalar_potential_;
   const std::shared_ptr<const nosh::scalar_field::base> thickness_;
 
-  const std::shared_ptr<nosh::parameter_matrix::keo> keo_;
+  // The kinetic energy operator, e.g., parameter_matrix::keo,
+  // parameter_matrix::keo_block, or parameter_matrix::keo_matrix_free;
+  // keo_op_ is its operator view.
+  const std::shared_ptr<nosh::parameter_object> keo_;
+  const std::shared_ptr<const Tpetra::Operator<double,int,int>> keo_op_;
   Tpetra::Vector<double,int,int> diag0_;
   Tpetra::Vector<double,int,int> diag1b_;
 };
@@ -24,6 +24,7 @@
 #include "vector_field_base.hpp"
 #include "parameter_matrix_keo.hpp"
 #include "mesh.hpp"
+#include "vector_pool.hpp"
 
 // =============================================================================
 // some typdefs for Belos
@@ -216,12 +217,11 @@ rebuild(
     //TEUCHOS_ASSERT_EQUALITY(0, regularizedkeo_.ReplaceDiagonal_values(diag));
     //
     const auto & control_volumes = *(mesh_->control_volumes());
-    const auto thickness_values = thickness_->get_v(params);
-#ifndef NDEBUG
-    TEUCHOS_ASSERT(control_volumes.getMap()->isSameAs(*thickness_values.getMap()));
-#endif
+    const auto thickness_values =
+      vector_pool::global().get(control_volumes.getMap());
+    thickness_->fill_v(params, *thickness_values);
     auto c_data = control_volumes.getData();
-    auto t_data = thickness_values.getData();
+    auto t_data = thickness_values->getData();
     auto x_data = x.getData();
 #ifndef NDEBUG
     TEUCHOS_ASSERT_EQUALITY(c_data.size(), t_data.size());
@@ -23,10 +23,11 @@ namespace nosh
           const std::vector<std::shared_ptr<const matrix_core_edge>> & matrix_core_edges,
           const std::vector<std::shared_ptr<const matrix_core_vertex>> & matrix_core_vertexs,
           const std::vector<std::shared_ptr<const matrix_core_boundary>> & matrix_core_boundarys,
-          const std::vector<std::shared_ptr<const matrix_core_dirichlet>> & dbcs
+          const std::vector<std::shared_ptr<const matrix_core_dirichlet>> & dbcs,
+          const bool symmetric_dbcs = false
           ) :
         mesh_(mesh),
-        matrix(std::make_shared<nosh::fvm_matrix>(mesh, matrix_core_edges, matrix_core_vertexs, matrix_core_boundarys, dbcs)),
+        matrix(std::make_shared<nosh::fvm_matrix>(mesh, matrix_core_edges, matrix_core_vertexs, matrix_core_boundarys, dbcs, symmetric_dbcs)),
         rhs(std::make_shared<Tpetra::Vector<double,int,int>>(Teuchos::rcp(mesh->map())))
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
         ,fill_time_(Teuchos::TimeMonitor::getNewTimer("Nosh: linear_problem::fill_"))
@@ -47,8 +48,9 @@ namespace nosh
           TEUCHOS_ASSERT(this->matrix);
           TEUCHOS_ASSERT(this->rhs);
 #endif
-          // Fill matrix and rhs
-          this->matrix->fill(rhs);
+          // Fill matrix and rhs. The sparsity never changes, so after the
+          // first fill, only the values are recomputed in place.
+          this->matrix->refill(rhs);
 
           return;
         }
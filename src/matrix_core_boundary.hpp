@@ -22,6 +22,7 @@ namespace nosh
 
       virtual ~matrix_core_boundary() = default;
 
+      //! May be called concurrently, see parallel_for.hpp.
       virtual
       boundary_data
       eval(const moab::EntityHandle & vertex) const = 0;
@@ -17,6 +17,7 @@ namespace nosh {
 
       virtual ~matrix_core_dirichlet() = default;
 
+      //! May be called concurrently, see parallel_for.hpp.
       virtual
       double
       eval(const moab::EntityHandle & vertex) const = 0;
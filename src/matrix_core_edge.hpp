@@ -2,6 +2,7 @@
 #define NOSH_MATRIX_CORE_EDGE_H
 
 #include <set>
+#include <vector>
 #include <Eigen/Dense>
 #include <moab/Core.hpp>
 
@@ -23,10 +24,35 @@ namespace nosh
 
       virtual ~matrix_core_edge() = default;
 
+      //! May be called concurrently, see parallel_for.hpp.
       virtual
       matrix_core_edge_data
       eval(const moab::EntityHandle & edge) const = 0;
 
+      //! Evaluates the core for num_edges edges at once without allocating.
+      //! The 2x2 block of edge k goes to lhs[4*k], ..., lhs[4*k + 3]
+      //! (row-major), its rhs to rhs[2*k], rhs[2*k + 1]. fvm_matrix assembles
+      //! through this; the default implementation adapts eval().
+      virtual
+      void
+      eval_batch(
+          const moab::EntityHandle * edges,
+          const int num_edges,
+          double * lhs,
+          double * rhs
+          ) const
+      {
+        for (int k = 0; k < num_edges; k++) {
+          const auto vals = this->eval(edges[k]);
+          lhs[4*k] = vals.lhs[0][0];
+          lhs[4*k + 1] = vals.lhs[0][1];
+          lhs[4*k + 2] = vals.lhs[1][0];
+          lhs[4*k + 3] = vals.lhs[1][1];
+          rhs[2*k] = vals.rhs[0];
+          rhs[2*k + 1] = vals.rhs[1];
+        }
+      }
+
     public:
       const std::set<std::string> subdomain_ids;
   };
@@ -22,6 +22,7 @@ namespace nosh
 
       virtual ~matrix_core_vertex() = default;
 
+      //! May be called concurrently, see parallel_for.hpp.
       virtual
       vertex_data
       eval(const moab::EntityHandle & vertex) const = 0;
@@ -1,10 +1,18 @@
 #include "mesh.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+
 #include <MBParallelConventions.h>
 #include <moab/Core.hpp>
 #include <moab/ParallelComm.hpp>
 #include <moab/Skinner.hpp>
 
+#include <Tpetra_Distributor.hpp>
 #include <Tpetra_Vector.hpp>
 #include <Teuchos_RCP.hpp>
 #include <Teuchos_RCPStdSharedPtrConversions.hpp>
@@ -15,11 +23,14 @@
 namespace nosh
 {
 // =============================================================================
+const int mesh::batch_size_;
+// =============================================================================
 mesh::
 mesh(
     std::shared_ptr<const Teuchos::Comm<int>>  _comm,
     std::shared_ptr<moab::ParallelComm>  mcomm,
-    const std::shared_ptr<moab::Core> & mb
+    const std::shared_ptr<moab::Core> & mb,
+    const std::shared_ptr<const mesh_cache> & cache
     ) :
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   write_time_(Teuchos::TimeMonitor::getNewTimer("Nosh: mesh::write")),
@@ -28,12 +39,15 @@ mesh(
   comm(std::move(_comm)),
   mbw_(std::make_shared<moab_wrap>(mb)),
   mcomm_(std::move(mcomm)),
+  cache_(cache && cache->is_loaded() ? cache : nullptr),
+  vertex_coords_(this->build_vertex_coords_()),
   vertices_map_(this->get_map_(this->get_owned_gids_())),
   vertices_overlap_map_(this->get_map_(this->get_overlap_gids_())),
   complex_map_(this->get_map_(this->complexify_(this->get_owned_gids_()))),
   complex_overlap_map_(
     this->get_map_(this->complexify_(this->get_overlap_gids_()))
     )
+  ,is_distributed_(!vertices_map_->isSameAs(*vertices_overlap_map_))
   ,relations_(this->build_entity_relations_())
   ,edge_lids(build_edge_lids_())
   ,edge_lids_complex(build_edge_lids_complex_())
@@ -43,6 +57,10 @@ mesh(
   ,boundary_vertices(compute_boundary_vertices_(boundary_skin_))
   ,meshsets_(create_default_meshsets_())
 {
+  for (const auto & id: {"everywhere", "boundary"}) {
+    this->subdomain_tables_[id] = this->build_subdomain_tables_(id);
+  }
+
 // TODO(nschloe): resurrect
 //#ifndef NDEBUG
 //  // Assert that all processes own vertices
@@ -54,6 +72,65 @@ mesh::
 ~mesh()
 = default;
 // =============================================================================
+void
+mesh::
+write_cache(mesh_cache & cache) const
+{
+  const size_t num_edges = this->relations_.edge_vertices.size();
+
+  std::vector<moab::EntityHandle> edge_vertices(2 * num_edges);
+  std::vector<int> edge_lids_flat(2 * num_edges);
+  std::vector<int> edge_gids_flat(2 * num_edges);
+  for (size_t k = 0; k < num_edges; k++) {
+    edge_vertices[2*k] = std::get<0>(this->relations_.edge_vertices[k]);
+    edge_vertices[2*k + 1] = std::get<1>(this->relations_.edge_vertices[k]);
+    edge_lids_flat[2*k] = this->edge_lids[k][0];
+    edge_lids_flat[2*k + 1] = this->edge_lids[k][1];
+    edge_gids_flat[2*k] = this->edge_gids[k][0];
+    edge_gids_flat[2*k + 1] = this->edge_gids[k][1];
+  }
+  cache.put("edge_vertices", edge_vertices);
+  cache.put("cell_edges", this->relations_.cell_edges);
+  cache.put("edge_lids", edge_lids_flat);
+  cache.put("edge_gids", edge_gids_flat);
+
+  cache.put("boundary_skin", this->boundary_skin_);
+  cache.put(
+      "boundary_vertices",
+      std::vector<moab::EntityHandle>(
+        this->boundary_vertices.begin(),
+        this->boundary_vertices.end()
+        )
+      );
+
+  const auto cv_data = this->control_volumes()->getData();
+  cache.put("control_volumes", std::vector<double>(cv_data.begin(), cv_data.end()));
+  cache.put("edge_data", this->get_edge_data());
+  cache.put("boundary_surface_areas", this->boundary_surface_areas());
+
+  return;
+}
+// =============================================================================
+std::shared_ptr<Tpetra::Vector<double,int,int>>
+mesh::
+get_cached_control_volumes_() const
+{
+#ifndef NDEBUG
+  TEUCHOS_ASSERT(this->cache_);
+#endif
+  const auto values = this->cache_->get<double>("control_volumes");
+  auto control_volumes = std::make_shared<Tpetra::Vector<double,int,int>>(
+      Teuchos::rcp(this->map())
+      );
+  auto cv_data = control_volumes->getDataNonConst();
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      values.size() != size_t(cv_data.size()),
+      "Mesh cache doesn't match the mesh (number of control volumes)."
+      );
+  std::copy(values.begin(), values.end(), cv_data.begin());
+  return control_volumes;
+}
+// =============================================================================
 std::map<std::string, moab::EntityHandle>
 mesh::
 create_default_meshsets_()
@@ -78,6 +155,10 @@ std::vector<moab::EntityHandle>
 mesh::
 compute_boundary_skin_() const
 {
+  if (this->cache_) {
+    return this->cache_->get<moab::EntityHandle>("boundary_skin");
+  }
+
   // Find the dimension we're operating on.
   const auto dim =
     this->mbw_->get_number_entities_by_type(0, moab::MBTET) > 0 ? 3 : 2;
@@ -123,6 +204,14 @@ compute_boundary_vertices_(
     const std::vector<moab::EntityHandle> & boundary_skin
     ) const
 {
+  if (this->cache_) {
+    const auto cached =
+      this->cache_->get<moab::EntityHandle>("boundary_vertices");
+    moab::Range verts;
+    std::copy(cached.begin(), cached.end(), moab::range_inserter(verts));
+    return verts;
+  }
+
   // get all vertices on the boundary edges
   const auto verts = this->mbw_->get_adjacencies(
       boundary_skin,
@@ -141,57 +230,258 @@ void
 mesh::
 mark_subdomains(const std::set<std::shared_ptr<nosh::subdomain>> & subdomains)
 {
-  const auto & owned_vertices = this->get_owned_vertices();
+  // Mark the ghost vertices, too, so that the edges to them are classified as
+  // they are on their owners (as for "everywhere"). The operators restrict the
+  // vertex contributions to the owned vertices themselves.
+  const moab::Range all_vertices = this->mbw_->get_entities_by_dimension(0, 0);
+
+  const int num_vertices = this->vertex_coords_.x.size();
+  const int num_edges = this->relations_.edge_vertices.size();
+
+  // number of points per is_inside_batch() call
+  const int chunk_size = 1024;
 
   for (const auto sd: subdomains) {
-    // create meshset
-    const auto meshset = this->mbw_->create_meshset(moab::MESHSET_SET);
-    this->meshsets_[sd->id] = meshset;
+    subdomain_tables tables;
 
-    // take care of the vertices
-    moab::Range verts = sd->is_boundary_only ?
+    // Gather the coordinates of the candidate vertices.
+    const moab::Range & verts = sd->is_boundary_only ?
       this->boundary_vertices :
-      owned_vertices;
+      all_vertices;
+    const int n = verts.size();
+    std::vector<int> lids(n);
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    std::vector<double> z(n);
+    int i = 0;
     for (const auto & vert: verts) {
-      const auto x = this->get_coords(vert);
-      if (sd->is_inside(x)) {
-        mbw_->add_entities(meshset, {vert});
+      const int lid = this->local_index(vert);
+      lids[i] = lid;
+      x[i] = this->vertex_coords_.x[lid];
+      y[i] = this->vertex_coords_.y[lid];
+      z[i] = this->vertex_coords_.z[lid];
+      i++;
+    }
+
+    std::vector<char> inside(n);
+    const int num_chunks = (n + chunk_size - 1) / chunk_size;
+#ifdef NOSH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int c = 0; c < num_chunks; c++) {
+      const int b = c * chunk_size;
+      sd->is_inside_batch(
+          &x[b], &y[b], &z[b],
+          std::min(chunk_size, n - b),
+          &inside[b]
+          );
+    }
+
+    tables.vertex_bits.assign((num_vertices + 63) / 64, 0);
+    for (int k = 0; k < n; k++) {
+      if (inside[k]) {
+        tables.vertex_bits[lids[k] >> 6] |= std::uint64_t(1) << (lids[k] & 63);
       }
     }
 
-    // Take care of the edges.
+    // Take care of the edges: Mark the ones with both vertices in the
+    // subdomain, and the ones with exactly ONE vertex in the subdomain (the
+    // boundary of the subdomain). Every thread writes entire words.
     // We never need edges on the boundaries, so skip that here.
-    if (sd->is_boundary_only) {
-      continue;
+    const int num_edge_words = (num_edges + 63) / 64;
+    tables.edge_bits.assign(num_edge_words, 0);
+    std::vector<std::uint64_t> half_edge_bits(num_edge_words, 0);
+    if (!sd->is_boundary_only) {
+#ifdef NOSH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int w = 0; w < num_edge_words; w++) {
+        std::uint64_t both = 0;
+        std::uint64_t one = 0;
+        const int end = std::min(64 * (w+1), num_edges);
+        for (int e = 64 * w; e < end; e++) {
+          const bool is_x0_inside = tables.contains_vertex(this->edge_lids[e][0]);
+          const bool is_x1_inside = tables.contains_vertex(this->edge_lids[e][1]);
+          both |= std::uint64_t(is_x0_inside && is_x1_inside) << (e & 63);
+          one |= std::uint64_t(is_x0_inside != is_x1_inside) << (e & 63);
+        }
+        tables.edge_bits[w] = both;
+        half_edge_bits[w] = one;
+      }
     }
 
-    // Create meshset for storing edges of which exactly ONE vertex is in the
-    // set (the boundary of the subdomain).
-    const auto halfedges_meshset =
-      this->mbw_->create_meshset(moab::MESHSET_SET);
-    this->meshsets_[sd->id + "_halfedges"] = halfedges_meshset;
+    this->fill_subdomain_tables_(tables, half_edge_bits);
 
-    const auto contained_verts = this->mbw_->get_entities_by_type(
-        meshset, moab::MBVERTEX
+    // Keep the meshsets for get_vertices(), get_edges(), and contains().
+    const auto meshset = this->mbw_->create_meshset(moab::MESHSET_SET);
+    this->meshsets_[sd->id] = meshset;
+    moab::Range entities;
+    std::copy(
+        tables.vertices.begin(), tables.vertices.end(),
+        moab::range_inserter(entities)
         );
-    const auto edges = this->mbw_->get_adjacencies(
-        contained_verts,
-        1,  // edges
-        false,  // don't create
-        moab::Interface::UNION
+    std::copy(
+        tables.edges.begin(), tables.edges.end(),
+        moab::range_inserter(entities)
         );
-    for (const auto & edge: edges) {
-      // Check if edge midpoint is_inside.
-      const auto v = this->mbw_->get_connectivity(edge);
-      const bool is_x0_inside = this->mbw_->contains_entities(meshset, {v[0]});
-      const bool is_x1_inside = this->mbw_->contains_entities(meshset, {v[1]});
-      if (is_x0_inside && is_x1_inside) {
-        mbw_->add_entities(meshset, {edge});
-      } else if (is_x0_inside || is_x1_inside) {
-        mbw_->add_entities(halfedges_meshset, {edge});
+    mbw_->add_entities(meshset, entities);
+
+    if (!sd->is_boundary_only) {
+      const auto halfedges_meshset =
+        this->mbw_->create_meshset(moab::MESHSET_SET);
+      this->meshsets_[sd->id + "_halfedges"] = halfedges_meshset;
+      moab::Range half_edges;
+      std::copy(
+          tables.half_edges.begin(), tables.half_edges.end(),
+          moab::range_inserter(half_edges)
+          );
+      mbw_->add_entities(halfedges_meshset, half_edges);
+    }
+
+    this->subdomain_tables_[sd->id] = std::move(tables);
+  }
+}
+// =============================================================================
+mesh::subdomain_tables
+mesh::
+build_subdomain_tables_(const std::string & subdomain_id) const
+{
+  subdomain_tables tables;
+
+  const int num_vertices = this->vertex_coords_.x.size();
+  const int num_edges = this->relations_.edge_vertices.size();
+
+  const auto set_bit = [](std::vector<std::uint64_t> & bits, const int lid) {
+    bits[lid >> 6] |= std::uint64_t(1) << (lid & 63);
+  };
+
+  tables.vertex_bits.assign((num_vertices + 63) / 64, 0);
+  for (const auto & vert: this->get_vertices(subdomain_id)) {
+    set_bit(tables.vertex_bits, this->local_index(vert));
+  }
+
+  tables.edge_bits.assign((num_edges + 63) / 64, 0);
+  for (const auto & edge: this->get_edges(subdomain_id)) {
+    set_bit(tables.edge_bits, this->local_index(edge));
+  }
+
+  // Boundary-only subdomains don't have half edges.
+  std::vector<std::uint64_t> half_edge_bits((num_edges + 63) / 64, 0);
+  const auto halfedges_id = subdomain_id + "_halfedges";
+  if (this->meshsets_.count(halfedges_id) > 0) {
+    for (const auto & edge: this->get_edges(halfedges_id)) {
+      set_bit(half_edge_bits, this->local_index(edge));
+    }
+  }
+
+  this->fill_subdomain_tables_(tables, half_edge_bits);
+
+  return tables;
+}
+// =============================================================================
+void
+mesh::
+fill_subdomain_tables_(
+    subdomain_tables & tables,
+    const std::vector<std::uint64_t> & half_edge_bits
+    ) const
+{
+  // Calls f(lid) for each set bit, in increasing order.
+  const auto for_each_bit = [](
+      const std::vector<std::uint64_t> & bits,
+      const std::function<void(int)> & f
+      ) {
+    for (size_t w = 0; w < bits.size(); w++) {
+      std::uint64_t word = bits[w];
+      while (word != 0) {
+        f(64 * w + __builtin_ctzll(word));
+        word &= word - 1;
+      }
+    }
+  };
+
+  // local IDs are MOAB IDs minus one, cf. local_index()
+  const auto handle = [&](const moab::EntityType type, const int lid) {
+    moab::EntityHandle h;
+    const auto rval = this->mbw_->mb->handle_from_id(type, lid + 1, h);
+#ifndef NDEBUG
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+#else
+    (void) rval;
+#endif
+    return h;
+  };
+
+  for_each_bit(tables.vertex_bits, [&](const int lid) {
+    tables.vertices.push_back(handle(moab::MBVERTEX, lid));
+    tables.vertex_lids.push_back(lid);
+  });
+
+  for_each_bit(tables.edge_bits, [&](const int lid) {
+    const auto & vlids = this->edge_lids[lid];
+    tables.edges.push_back(handle(moab::MBEDGE, lid));
+    tables.edge_table.push_back({{lid, vlids[0], vlids[1]}});
+  });
+
+  for_each_bit(half_edge_bits, [&](const int lid) {
+    const auto & vlids = this->edge_lids[lid];
+    // check which one of the two verts is in the subdomain
+    int side;
+    if (tables.contains_vertex(vlids[0])) {
+      side = 0;
+    } else if (tables.contains_vertex(vlids[1])) {
+      side = 1;
+    } else {
+      TEUCHOS_TEST_FOR_EXCEPT_MSG(
+          true,
+          "Neither of the two edge vertices is contained in the subdomain."
+          );
+    }
+    tables.half_edges.push_back(handle(moab::MBEDGE, lid));
+    tables.half_edge_table.push_back({{lid, vlids[side], side}});
+  });
+
+#ifdef NOSH_THREADED
+  // Greedy coloring: Each sweep takes all remaining items that don't touch a
+  // row already taken in the sweep.
+  const int num_edges = tables.edge_table.size();
+  const int num_items = num_edges + tables.half_edge_table.size();
+  std::vector<int> remaining(num_items);
+  std::iota(remaining.begin(), remaining.end(), 0);
+  std::vector<int> taken_in(this->vertex_coords_.x.size(), -1);
+  tables.color_ptrs.push_back(0);
+  for (int color = 0; !remaining.empty(); color++) {
+    std::vector<int> next;
+    for (const int item: remaining) {
+      int rows[2];
+      int num_rows;
+      if (item < num_edges) {
+        rows[0] = tables.edge_table[item][1];
+        rows[1] = tables.edge_table[item][2];
+        num_rows = 2;
+      } else {
+        rows[0] = tables.half_edge_table[item - num_edges][1];
+        num_rows = 1;
+      }
+      bool is_free = true;
+      for (int i = 0; i < num_rows; i++) {
+        is_free = is_free && taken_in[rows[i]] != color;
+      }
+      if (is_free) {
+        for (int i = 0; i < num_rows; i++) {
+          taken_in[rows[i]] = color;
+        }
+        tables.color_items.push_back(item);
+      } else {
+        next.push_back(item);
       }
     }
+    tables.color_ptrs.push_back(tables.color_items.size());
+    remaining.swap(next);
   }
+#endif
+
+  return;
 }
 // =============================================================================
 moab::Range
@@ -233,6 +523,19 @@ get_vertex_tuple(const moab::EntityHandle & edge) const
   return this->mbw_->get_adjacencies({edge}, 0, false);
 }
 // =============================================================================
+const mesh::subdomain_tables &
+mesh::
+get_subdomain_tables(const std::string & subdomain_id) const
+{
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+    this->subdomain_tables_.count(subdomain_id) == 0,
+    "Subdomain \"" << subdomain_id << "\" not found on mesh. "
+      << "Did you call mark_subdomains({...}) on the mesh?"
+      );
+
+  return this->subdomain_tables_.at(subdomain_id);
+}
+// =============================================================================
 bool
 mesh::
 contains(
@@ -286,7 +589,31 @@ get_coords(
   const moab::EntityHandle vertex
   ) const
 {
-  return Eigen::Vector3d(this->mbw_->get_coords({vertex}).data());
+  const auto k = this->local_index(vertex);
+  return Eigen::Vector3d(
+      this->vertex_coords_.x[k],
+      this->vertex_coords_.y[k],
+      this->vertex_coords_.z[k]
+      );
+}
+// =============================================================================
+mesh::vertex_coordinates
+mesh::
+build_vertex_coords_() const
+{
+  // Fetch all coordinates at once; they are indexed by local vertex ID from
+  // here on.
+  const moab::Range verts = this->mbw_->get_entities_by_dimension(0, 0);
+#ifndef NDEBUG
+  if (!verts.empty()) {
+    TEUCHOS_ASSERT_EQUALITY(this->local_index(verts.front()), 0);
+    TEUCHOS_ASSERT_EQUALITY(this->local_index(verts.back()), verts.size() - 1);
+  }
+#endif
+
+  auto coords = this->mbw_->get_coords(verts);
+
+  return {std::move(coords[0]), std::move(coords[1]), std::move(coords[2])};
 }
 // =============================================================================
 std::shared_ptr<Tpetra::Vector<double,int,int>>
@@ -449,6 +776,15 @@ const std::vector<Teuchos::Tuple<int,2>>
 mesh::
 build_edge_lids_() const
 {
+  if (this->cache_) {
+    const auto lids = this->cache_->get<int>("edge_lids");
+    std::vector<Teuchos::Tuple<int,2>> _edge_lids(lids.size() / 2);
+    for (std::size_t k = 0; k < _edge_lids.size(); k++) {
+      _edge_lids[k] = Teuchos::tuple(lids[2*k], lids[2*k + 1]);
+    }
+    return _edge_lids;
+  }
+
   const std::vector<edge> edges = this->my_edges();
 
   std::vector<Teuchos::Tuple<int,2>> _edge_lids(edges.size());
@@ -488,6 +824,15 @@ const std::vector<Teuchos::Tuple<int,2>>
 mesh::
 build_edge_gids_() const
 {
+  if (this->cache_) {
+    const auto gids = this->cache_->get<int>("edge_gids");
+    std::vector<Teuchos::Tuple<int,2>> _edge_gids(gids.size() / 2);
+    for (std::size_t k = 0; k < _edge_gids.size(); k++) {
+      _edge_gids[k] = Teuchos::tuple(gids[2*k], gids[2*k + 1]);
+    }
+    return _edge_gids;
+  }
+
   const std::vector<edge> edges = this->my_edges();
 
   std::vector<Teuchos::Tuple<int,2>> _edge_gids(edges.size());
@@ -513,22 +858,15 @@ const std::vector<Teuchos::Tuple<int,4>>
 mesh::
 build_edge_gids_complex_() const
 {
-  const std::vector<edge> edges = this->my_edges();
-
-  std::vector<Teuchos::Tuple<int,4>> _edge_gids_complex(edges.size());
-
-  const moab::Tag gid = this->mbw_->tag_get_handle("GLOBAL_ID");
-
-  for (std::size_t k = 0; k < edges.size(); k++) {
-    // get the global IDs of the vertices
-    const std::vector<moab::EntityHandle> entities =
-      {std::get<0>(edges[k]), std::get<1>(edges[k])};
-    const auto global_ids = this->mbw_->tag_get_int_data(gid, entities);
+  // edge_gids is initialized before, so don't query the GLOBAL_ID tag again.
+  std::vector<Teuchos::Tuple<int,4>> _edge_gids_complex(this->edge_gids.size());
 
+  for (std::size_t k = 0; k < this->edge_gids.size(); k++) {
+    const auto & gids = this->edge_gids[k];
     _edge_gids_complex[k] =
       Teuchos::tuple(
-          2*global_ids[0], 2*global_ids[0] + 1,
-          2*global_ids[1], 2*global_ids[1] + 1
+          2*gids[0], 2*gids[0] + 1,
+          2*gids[1], 2*gids[1] + 1
           );
   }
 
@@ -630,6 +968,26 @@ mesh::entity_relations
 mesh::
 build_entity_relations_()
 {
+  if (this->cache_) {
+    const auto verts = this->cache_->get<moab::EntityHandle>("edge_vertices");
+    std::vector<edge> edge_vertices(verts.size() / 2);
+    for (size_t k = 0; k < edge_vertices.size(); k++) {
+      edge_vertices[k] = std::make_tuple(verts[2*k], verts[2*k + 1]);
+    }
+    // The edges themselves have been created by the reader.
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        edge_vertices.size() != static_cast<size_t>(
+          this->mbw_->get_number_entities_by_type(0, moab::MBEDGE)
+          ),
+        "Mesh cache doesn't match the mesh (number of edges)."
+        );
+    mesh::entity_relations relations = {
+      edge_vertices,
+      this->cache_->get<int>("cell_edges")
+    };
+    return relations;
+  }
+
   // get the number of 3D entities
   const int num3d = this->mbw_->get_number_entities_by_dimension(0, 3);
 
@@ -646,36 +1004,66 @@ build_entity_relations_()
       moab::Interface::UNION
       );
 
-  // create cell->edge relation
-  std::vector<std::vector<moab::EntityHandle>> cell_edges(elems.size());
-  for (size_t k = 0; k < elems.size(); k++) {
-    const auto ce = this->mbw_->get_adjacencies(
-          {elems[k]},
-          1,
-          true,
-          moab::Interface::UNION
-          );
+  // Create edge->node relation from the edge connectivity arrays. As before,
+  // the edge vertices are sorted by handle. The position of an edge in
+  // `edges` equals its local_index().
+  int verts_per_edge = 0;
+  const auto edge_conn = this->mbw_->connect_iterate(edges, verts_per_edge);
+  const size_t num_edges = edges.size();
+  std::vector<std::tuple<moab::EntityHandle, moab::EntityHandle>>
+    edge_vertices(num_edges);
+  // Vertex local ID pair -> edge local ID
+  std::unordered_map<std::uint64_t, int> edge_index(2 * num_edges);
+  const auto edge_key = [](const int i, const int j) {
+    return (static_cast<std::uint64_t>(std::min(i, j)) << 32)
+      | static_cast<std::uint64_t>(std::max(i, j));
+  };
+  for (size_t k = 0; k < num_edges; k++) {
+    const auto v0 = edge_conn[verts_per_edge*k];
+    const auto v1 = edge_conn[verts_per_edge*k + 1];
+    edge_vertices[k] = std::make_tuple(std::min(v0, v1), std::max(v0, v1));
+    edge_index[edge_key(this->local_index(v0), this->local_index(v1))] = k;
+  }
 
-    cell_edges[k].resize(ce.size());
-    for (size_t i = 0; i < ce.size(); i++) {
-      cell_edges[k][i] = ce[i];
+  // Create cell->edge relation. The edges of a cell are stored in the order
+  // (0,1), (0,2), (1,2) for triangles and (0,1), (0,2), (0,3), (1,2), (1,3),
+  // (2,3) for tetrahedra, referring to the cell's vertex connectivity.
+  int verts_per_cell = 0;
+  const auto cell_conn = this->mbw_->connect_iterate(elems, verts_per_cell);
+  const int num_corners = dim + 1;
+  std::vector<std::array<int, 2>> local_edges;
+  for (int i = 0; i < num_corners; i++) {
+    for (int j = i + 1; j < num_corners; j++) {
+      local_edges.push_back({{i, j}});
     }
   }
+  const int edges_per_cell = local_edges.size();
 
-  // create edge->node relation
-  std::vector<std::tuple<moab::EntityHandle, moab::EntityHandle>>
-    edge_vertices(edges.size());
-
-  for (size_t k = 0; k < edges.size(); k++) {
-    moab::Range verts = this->mbw_->get_adjacencies(
-        {edges[k]},
-        0,
-        true,
-        moab::Interface::UNION
-        );
-
-    edge_vertices[k] = std::make_tuple(verts[0], verts[1]);
+  const long num_cells = elems.size();
+  std::vector<int> cell_edges(edges_per_cell * num_cells);
+  int num_missing = 0;
+#ifdef NOSH_OPENMP
+#pragma omp parallel for schedule(static) reduction(+:num_missing)
+#endif
+  for (long k = 0; k < num_cells; k++) {
+    const moab::EntityHandle * conn = &cell_conn[verts_per_cell*k];
+    for (int i = 0; i < edges_per_cell; i++) {
+      const auto it = edge_index.find(edge_key(
+            this->local_index(conn[local_edges[i][0]]),
+            this->local_index(conn[local_edges[i][1]])
+            ));
+      if (it == edge_index.end()) {
+        num_missing++;
+        cell_edges[edges_per_cell*k + i] = -1;
+      } else {
+        cell_edges[edges_per_cell*k + i] = it->second;
+      }
+    }
   }
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      num_missing > 0,
+      num_missing << " cell edges not found in the edge list."
+      );
 
   mesh::entity_relations relations = {edge_vertices, cell_edges};
 
@@ -765,23 +1153,11 @@ build_graph() const
   //    Teuchos::rcp(nonoverlap_map),
   //    0
   //    ));
-  const auto graph = Tpetra::createCrsGraph(Teuchos::rcp(nonoverlap_map));
-
-  const std::vector<edge> edges = this->my_edges();
-
-  // Loop over all edges and put entries wherever two vertices are connected.
-  // TODO(nschloe): check if we can use LIDs here
-  for (size_t k = 0; k < edges.size(); k++) {
-    const Teuchos::Tuple<int,2> & idx = this->edge_gids[k];
-    for (int i = 0; i < 2; i++) {
-      graph->insertGlobalIndices(idx[i], idx);
-      // graph->insertLocalIndices(idx[i], idx);
-    }
-  }
-
-  graph->fillComplete();
-
-  return graph;
+  return this->build_graph_from_local_crs_(
+      nonoverlap_map,
+      this->overlap_map(),
+      1
+      );
 }
 // =============================================================================
 Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
@@ -858,24 +1234,448 @@ build_complex_graph() const
   //     Teuchos::rcp(nonoverlap_map),
   //     0
   //     ));
-  const auto graph = Tpetra::createCrsGraph(Teuchos::rcp(nonoverlap_map));
+  // The complex graph is the scalar one with every entry expanded into a 2x2
+  // block.
+  return this->build_graph_from_local_crs_(
+      nonoverlap_map,
+      this->overlap_complex_map(),
+      2
+      );
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+mesh::
+graph() const
+{
+  if (this->graph_.is_null()) {
+    this->graph_ = this->build_graph();
+  }
+  return this->graph_;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+mesh::
+complex_graph() const
+{
+  if (this->complex_graph_.is_null()) {
+    this->complex_graph_ = this->build_complex_graph();
+  }
+  return this->complex_graph_;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+mesh::
+overlap_graph() const
+{
+  if (!this->is_distributed_) {
+    return this->graph();
+  }
 
-  const std::vector<edge> edges = this->my_edges();
+  if (this->overlap_graph_.is_null()) {
+    Teuchos::ArrayRCP<size_t> row_ptrs;
+    Teuchos::ArrayRCP<int> col_idx;
+    this->build_local_crs_(1, row_ptrs, col_idx);
+
+    const auto rcp_overlap_map = Teuchos::rcp(this->overlap_map());
+    const auto graph = Teuchos::rcp(new Tpetra::CrsGraph<int,int>(
+          rcp_overlap_map,
+          rcp_overlap_map,
+          row_ptrs,
+          col_idx
+          ));
+    graph->expertStaticFillComplete(rcp_overlap_map, rcp_overlap_map);
+    this->overlap_graph_ = graph;
+  }
+  return this->overlap_graph_;
+}
+// =============================================================================
+const mesh::crs_offsets &
+mesh::
+overlap_crs_offsets() const
+{
+  if (this->overlap_crs_offsets_) {
+    return *this->overlap_crs_offsets_;
+  }
+
+  const auto graph = this->overlap_graph();
+  const auto map = this->map();
+  const auto overlap_map = this->overlap_map();
+  const auto col_map = graph->getColMap();
+  const auto row_ptrs = graph->getNodeRowPtrs();
+
+  const int num_vertices = overlap_map->getNodeNumElements();
+  std::vector<int> col_lids(num_vertices);
+  for (int i = 0; i < num_vertices; i++) {
+    col_lids[i] = col_map->getLocalElement(overlap_map->getGlobalElement(i));
+  }
+
+  const auto offset = [&](const int row, const int col) {
+    Teuchos::ArrayView<const int> cols;
+    graph->getLocalRowView(row, cols);
+    const auto it = std::find(cols.begin(), cols.end(), col_lids[col]);
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        it == cols.end(),
+        "Entry (" << row << ", " << col << ") not in graph."
+        );
+    return row_ptrs[row] + (it - cols.begin());
+  };
+
+  auto offsets = std::make_shared<crs_offsets>();
+
+  offsets->diagonals.resize(num_vertices);
+  for (int i = 0; i < num_vertices; i++) {
+    const bool is_owned = map->isNodeGlobalElement(
+        overlap_map->getGlobalElement(i)
+        );
+    offsets->diagonals[i] = is_owned ?
+      offset(i, i) :
+      Teuchos::OrdinalTraits<size_t>::invalid();
+  }
+
+  offsets->edges.resize(this->edge_lids.size());
+  for (size_t k = 0; k < this->edge_lids.size(); k++) {
+    const int i0 = this->edge_lids[k][0];
+    const int i1 = this->edge_lids[k][1];
+    offsets->edges[k] = {{
+      offset(i0, i0), offset(i0, i1), offset(i1, i0), offset(i1, i1)
+    }};
+  }
 
-  // Loop over all edges and put entries wherever two vertices are connected.
-  // TODO(nschloe): check if we can use LIDs here
-  for (size_t k = 0; k < edges.size(); k++) {
-    const Teuchos::Tuple<int,4> & idx = this->edge_gids_complex[k];
+  this->overlap_crs_offsets_ = offsets;
+  return *this->overlap_crs_offsets_;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+mesh::
+overlap_complex_graph() const
+{
+  if (!this->is_distributed_) {
+    return this->complex_graph();
+  }
+
+  if (this->overlap_complex_graph_.is_null()) {
+    Teuchos::ArrayRCP<size_t> row_ptrs;
+    Teuchos::ArrayRCP<int> col_idx;
+    this->build_local_crs_(2, row_ptrs, col_idx);
+
+    const auto rcp_overlap_map = Teuchos::rcp(this->overlap_complex_map());
+    const auto graph = Teuchos::rcp(new Tpetra::CrsGraph<int,int>(
+          rcp_overlap_map,
+          rcp_overlap_map,
+          row_ptrs,
+          col_idx
+          ));
+    graph->expertStaticFillComplete(rcp_overlap_map, rcp_overlap_map);
+    this->overlap_complex_graph_ = graph;
+  }
+  return this->overlap_complex_graph_;
+}
+// =============================================================================
+const mesh::complex_crs_offsets &
+mesh::
+overlap_complex_crs_offsets() const
+{
+  if (this->overlap_complex_crs_offsets_) {
+    return *this->overlap_complex_crs_offsets_;
+  }
+
+  const auto graph = this->overlap_complex_graph();
+  const auto overlap_map = this->overlap_complex_map();
+  const auto col_map = graph->getColMap();
+  const auto row_ptrs = graph->getNodeRowPtrs();
+
+  const int num_dofs = overlap_map->getNodeNumElements();
+  std::vector<int> col_lids(num_dofs);
+  for (int i = 0; i < num_dofs; i++) {
+    col_lids[i] = col_map->getLocalElement(overlap_map->getGlobalElement(i));
+  }
+
+  const auto offset = [&](const int row, const int col) {
+    Teuchos::ArrayView<const int> cols;
+    graph->getLocalRowView(row, cols);
+    const auto it = std::find(cols.begin(), cols.end(), col_lids[col]);
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        it == cols.end(),
+        "Entry (" << row << ", " << col << ") not in graph."
+        );
+    return row_ptrs[row] + (it - cols.begin());
+  };
+
+  auto offsets = std::make_shared<complex_crs_offsets>();
+  offsets->edges.resize(this->edge_lids_complex.size());
+  for (size_t k = 0; k < this->edge_lids_complex.size(); k++) {
+    const auto & idx = this->edge_lids_complex[k];
     for (int i = 0; i < 4; i++) {
-#ifdef NDEBUG
-      TEUCHOS_ASSERT_INEQUALITY(idx[i], >=, 0);
+      for (int j = 0; j < 4; j++) {
+        offsets->edges[k][4*i + j] = offset(idx[i], idx[j]);
+      }
+    }
+  }
+
+  this->overlap_complex_crs_offsets_ = offsets;
+  return *this->overlap_complex_crs_offsets_;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::Import<int,int>>
+mesh::
+importer() const
+{
+  if (this->importer_.is_null()) {
+    this->importer_ = Tpetra::createImport(
+        Teuchos::rcp(this->map()),
+        Teuchos::rcp(this->overlap_map())
+        );
+  }
+  return this->importer_;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::Export<int,int>>
+mesh::
+exporter() const
+{
+  if (this->exporter_.is_null()) {
+    this->exporter_ = Tpetra::createExport(
+        Teuchos::rcp(this->overlap_map()),
+        Teuchos::rcp(this->map())
+        );
+  }
+  return this->exporter_;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::Import<int,int>>
+mesh::
+complex_importer() const
+{
+  if (this->complex_importer_.is_null()) {
+    this->complex_importer_ = Tpetra::createImport(
+        Teuchos::rcp(this->complex_map()),
+        Teuchos::rcp(this->overlap_complex_map())
+        );
+  }
+  return this->complex_importer_;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::Export<int,int>>
+mesh::
+complex_exporter() const
+{
+  if (this->complex_exporter_.is_null()) {
+    this->complex_exporter_ = Tpetra::createExport(
+        Teuchos::rcp(this->overlap_complex_map()),
+        Teuchos::rcp(this->complex_map())
+        );
+  }
+  return this->complex_exporter_;
+}
+// =============================================================================
+void
+mesh::
+build_local_crs_(
+    const int block_size,
+    Teuchos::ArrayRCP<size_t> & row_ptrs,
+    Teuchos::ArrayRCP<int> & col_idx
+    ) const
+{
+  // Build the vertex adjacency on the local (overlap) vertex IDs, with every
+  // entry expanded into a block_size x block_size block.
+  const size_t num_vertices = this->overlap_map()->getNodeNumElements();
+
+  // Count the row lengths: the diagonal plus one entry per adjacent edge.
+  std::vector<size_t> ptrs(num_vertices + 1, 0);
+  for (const auto & idx: this->edge_lids) {
+    ptrs[idx[0] + 1]++;
+    ptrs[idx[1] + 1]++;
+  }
+  for (size_t i = 0; i < num_vertices; i++) {
+    ptrs[i + 1] += ptrs[i] + 1;
+  }
+
+  // Fill in the column indices and sort them row by row.
+  std::vector<int> cols(ptrs[num_vertices]);
+  std::vector<size_t> pos(ptrs.begin(), ptrs.end() - 1);
+  for (size_t i = 0; i < num_vertices; i++) {
+    cols[pos[i]++] = i;
+  }
+  for (const auto & idx: this->edge_lids) {
+    cols[pos[idx[0]]++] = idx[1];
+    cols[pos[idx[1]]++] = idx[0];
+  }
+  for (size_t i = 0; i < num_vertices; i++) {
+    std::sort(cols.begin() + ptrs[i], cols.begin() + ptrs[i + 1]);
+  }
+
+  // Expand into blocks. Block rows/columns of vertex i are
+  // block_size*i, ..., block_size*i + block_size-1 (cf. complexify_()), so
+  // the column indices stay sorted.
+  row_ptrs = Teuchos::ArrayRCP<size_t>(block_size * num_vertices + 1);
+  col_idx = Teuchos::ArrayRCP<int>(block_size * block_size * cols.size());
+  row_ptrs[0] = 0;
+  size_t l = 0;
+  for (size_t i = 0; i < num_vertices; i++) {
+    for (int r = 0; r < block_size; r++) {
+      for (size_t k = ptrs[i]; k < ptrs[i + 1]; k++) {
+        for (int c = 0; c < block_size; c++) {
+          col_idx[l++] = block_size * cols[k] + c;
+        }
+      }
+      row_ptrs[block_size * i + r + 1] = l;
+    }
+  }
+
+  return;
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+mesh::
+build_graph_from_local_crs_(
+    const std::shared_ptr<const Tpetra::Map<int,int>> & map,
+    const std::shared_ptr<const Tpetra::Map<int,int>> & overlap_map,
+    const int block_size
+    ) const
+{
+  Teuchos::ArrayRCP<size_t> row_ptrs;
+  Teuchos::ArrayRCP<int> col_idx;
+  this->build_local_crs_(block_size, row_ptrs, col_idx);
+
+  const auto rcp_map = Teuchos::rcp(map);
+
+  if (!this->is_distributed_) {
+    // All local vertices are owned (e.g., in serial runs), so the local
+    // structure already is the final graph. It's sorted and merged, so skip
+    // the checks in fillComplete().
+    const auto graph = Teuchos::rcp(new Tpetra::CrsGraph<int,int>(
+          rcp_map,
+          rcp_map,
+          row_ptrs,
+          col_idx
+          ));
+    graph->expertStaticFillComplete(rcp_map, rcp_map);
+    return graph;
+  }
+
+  // Otherwise, the rows of the shared vertices are incomplete: some of their
+  // edges are only known to other processes. Every process sends the rows of
+  // the local vertices it doesn't own to their owners, along the plan of the
+  // mesh's Export, and the owners merge them into their own rows.
+  const auto exporter =
+    (block_size == 1) ? this->exporter() : this->complex_exporter();
+#ifndef NDEBUG
+  TEUCHOS_ASSERT(exporter->getSourceMap()->isSameAs(*overlap_map));
 #endif
-      graph->insertGlobalIndices(idx[i], idx);
-      //graph->insertLocalIndices(idx[i], idx);
+  const auto export_lids = exporter->getExportLIDs();
+  const auto remote_lids = exporter->getRemoteLIDs();
+
+  Teuchos::Array<size_t> num_export(export_lids.size());
+  Teuchos::Array<int> export_cols;
+  for (int k = 0; k < export_lids.size(); k++) {
+    const int row = export_lids[k];
+    num_export[k] = row_ptrs[row + 1] - row_ptrs[row];
+    for (size_t l = row_ptrs[row]; l < row_ptrs[row + 1]; l++) {
+      export_cols.push_back(overlap_map->getGlobalElement(col_idx[l]));
     }
   }
 
-  graph->fillComplete();
+  auto & distributor = exporter->getDistributor();
+  Teuchos::Array<size_t> num_import(remote_lids.size());
+  distributor.doPostsAndWaits<size_t>(
+      num_export().getConst(), 1, num_import()
+      );
+  Teuchos::Array<int> import_cols(
+      std::accumulate(num_import.begin(), num_import.end(), size_t(0))
+      );
+  distributor.doPostsAndWaits<int>(
+      export_cols().getConst(), num_export().getConst(),
+      import_cols(), num_import().getConst()
+      );
+
+  // The owned rows, with global column indices: the local entries plus the
+  // received ones.
+  const size_t num_rows = map->getNodeNumElements();
+  std::vector<int> overlap_lids(num_rows);
+  std::vector<size_t> ptrs(num_rows + 1, 0);
+  for (size_t i = 0; i < num_rows; i++) {
+    overlap_lids[i] = overlap_map->getLocalElement(map->getGlobalElement(i));
+    ptrs[i + 1] = row_ptrs[overlap_lids[i] + 1] - row_ptrs[overlap_lids[i]];
+  }
+  for (int k = 0; k < remote_lids.size(); k++) {
+    ptrs[remote_lids[k] + 1] += num_import[k];
+  }
+  std::partial_sum(ptrs.begin(), ptrs.end(), ptrs.begin());
+
+  std::vector<int> gids(ptrs[num_rows]);
+  std::vector<size_t> pos(ptrs.begin(), ptrs.end() - 1);
+  for (size_t i = 0; i < num_rows; i++) {
+    const int row = overlap_lids[i];
+    for (size_t l = row_ptrs[row]; l < row_ptrs[row + 1]; l++) {
+      gids[pos[i]++] = overlap_map->getGlobalElement(col_idx[l]);
+    }
+  }
+  size_t m = 0;
+  for (int k = 0; k < remote_lids.size(); k++) {
+    const int i = remote_lids[k];
+    for (size_t l = 0; l < num_import[k]; l++) {
+      gids[pos[i]++] = import_cols[m++];
+    }
+  }
+
+  // The column map: the owned indices first, then the others in ascending
+  // order.
+  std::vector<int> remote_gids;
+  for (const int gid: gids) {
+    if (!map->isNodeGlobalElement(gid)) {
+      remote_gids.push_back(gid);
+    }
+  }
+  std::sort(remote_gids.begin(), remote_gids.end());
+  remote_gids.erase(
+      std::unique(remote_gids.begin(), remote_gids.end()),
+      remote_gids.end()
+      );
+  const auto owned_gids = map->getNodeElementList();
+  std::vector<int> col_gids(owned_gids.begin(), owned_gids.end());
+  col_gids.insert(col_gids.end(), remote_gids.begin(), remote_gids.end());
+  const auto col_map = Teuchos::rcp(new Tpetra::Map<int,int>(
+        Teuchos::OrdinalTraits<Tpetra::global_size_t>::invalid(),
+        col_gids,
+        map->getIndexBase(),
+        map->getComm()
+        ));
+
+  // Local column indices, sorted and merged row by row
+  const auto col_lid = [&](const int gid) -> int {
+    const int lid = map->getLocalElement(gid);
+    if (lid != Teuchos::OrdinalTraits<int>::invalid()) {
+      return lid;
+    }
+    return num_rows + static_cast<int>(
+        std::lower_bound(remote_gids.begin(), remote_gids.end(), gid)
+        - remote_gids.begin()
+        );
+  };
+  std::vector<int> lids(gids.size());
+  Teuchos::ArrayRCP<size_t> graph_row_ptrs(num_rows + 1);
+  graph_row_ptrs[0] = 0;
+  size_t l = 0;
+  for (size_t i = 0; i < num_rows; i++) {
+    const auto begin = lids.begin() + l;
+    auto end = begin;
+    for (size_t k = ptrs[i]; k < ptrs[i + 1]; k++) {
+      *end++ = col_lid(gids[k]);
+    }
+    std::sort(begin, end);
+    l = std::unique(begin, end) - lids.begin();
+    graph_row_ptrs[i + 1] = l;
+  }
+  Teuchos::ArrayRCP<int> graph_col_idx(l);
+  std::copy(lids.begin(), lids.begin() + l, graph_col_idx.begin());
+
+  const auto graph = Teuchos::rcp(new Tpetra::CrsGraph<int,int>(
+        rcp_map,
+        col_map,
+        graph_row_ptrs,
+        graph_col_idx
+        ));
+  graph->expertStaticFillComplete(rcp_map, rcp_map);
 
   return graph;
 }
@@ -926,28 +1726,23 @@ compute_triangle_circumcenter_(
   return alpha * node0 + beta * node1 + gamma * node2;
 }
 // =============================================================================
-std::vector<double>
+std::array<double,3>
 mesh::
 compute_triangle_splitting_(
-    const std::vector<moab::EntityHandle> & conn
+    const int i0,
+    const int i1,
+    const int i2
     ) const
 {
-#ifndef NDEBUG
-  TEUCHOS_ASSERT_EQUALITY(conn.size(), 3);
-#endif
-
-  std::vector<double> splitting = {0.0, 0.0, 0.0};
+  std::array<double,3> splitting = {{0.0, 0.0, 0.0}};
 
   // Fetch the nodal positions into 'local_node_coords'.
-  std::vector<double> coords = this->mbw_->get_coords(conn);
-
-  std::vector<Eigen::Vector3d> local_node_coords(conn.size());
-  for (size_t i = 0; i < conn.size(); i++) {
-    // TODO(nschloe): do something smarter than copying here
-    local_node_coords[i][0] = coords[3*i];
-    local_node_coords[i][1] = coords[3*i + 1];
-    local_node_coords[i][2] = coords[3*i + 2];
-  }
+  const auto & x = this->vertex_coords_;
+  const std::vector<Eigen::Vector3d> local_node_coords = {
+    Eigen::Vector3d(x.x[i0], x.y[i0], x.z[i0]),
+    Eigen::Vector3d(x.x[i1], x.y[i1], x.z[i1]),
+    Eigen::Vector3d(x.x[i2], x.y[i2], x.z[i2])
+  };
 
   // compute the circumcenter of the cell
   const Eigen::Vector3d cc =
@@ -977,6 +1772,22 @@ compute_triangle_splitting_(
   return splitting;
 }
 // =============================================================================
+std::vector<int>
+mesh::
+get_connectivity_lids_(
+    const std::vector<moab::EntityHandle> & entities
+    ) const
+{
+  const auto conn = this->mbw_->get_connectivity(entities, true);
+
+  std::vector<int> lids(conn.size());
+  for (size_t k = 0; k < conn.size(); k++) {
+    lids[k] = this->local_index(conn[k]);
+  }
+
+  return lids;
+}
+// =============================================================================
 unsigned int
 mesh::
 get_other_index_(unsigned int e0, unsigned int e1) const
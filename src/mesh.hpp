@@ -2,6 +2,10 @@
 #define NOSH_MESH_HPP
 
 // includes
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -9,6 +13,8 @@
 
 #include <Teuchos_RCP.hpp>
 #include <Tpetra_CrsGraph.hpp>
+#include <Tpetra_Export.hpp>
+#include <Tpetra_Import.hpp>
 #include <Tpetra_Map.hpp>
 #include <Tpetra_Vector.hpp>
 
@@ -18,7 +24,13 @@
 
 #include <Eigen/Dense>
 
+#ifdef NOSH_OPENMP
+#include <omp.h>
+#endif
+
+#include "mesh_cache.hpp"
 #include "moab_wrap.hpp"
+#include "parallel_for.hpp"
 #include "subdomain.hpp"
 
 typedef std::tuple<moab::EntityHandle, moab::EntityHandle> edge;
@@ -32,8 +44,9 @@ private:
   struct entity_relations {
     //! Local edge ID -> Global node IDs.
     std::vector<edge> edge_vertices;
-    //! Local cell ID -> Local edge IDs.
-    std::vector<std::vector<moab::EntityHandle>> cell_edges;
+    //! Local cell ID -> Local edge IDs, flat with stride 3 (triangles) or 6
+    //! (tetrahedra); see build_entity_relations_() for the order.
+    std::vector<int> cell_edges;
   };
 
 public:
@@ -43,21 +56,97 @@ public:
     double covolume;
   };
 
+  //! Vertex coordinates as contiguous x, y, z arrays, indexed by local vertex
+  //! ID.
+  struct vertex_coordinates {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+  };
+
   struct boundary_data {
     moab::Range vertices;
     std::vector<double> surface_areas;
   };
 
+  //! Flat index tables of a subdomain. They are built once when the subdomain
+  //! is marked such that the operator and matrix loops don't have to go
+  //! through MOAB meshset and adjacency queries.
+  struct subdomain_tables {
+    //! Vertices in the subdomain and their local IDs.
+    std::vector<moab::EntityHandle> vertices;
+    std::vector<int> vertex_lids;
+    //! Edges with both vertices in the subdomain.
+    std::vector<moab::EntityHandle> edges;
+    //! (edge LID, vertex 0 LID, vertex 1 LID) for each edge.
+    std::vector<std::array<int,3>> edge_table;
+    //! Edges with exactly one vertex in the subdomain.
+    std::vector<moab::EntityHandle> half_edges;
+    //! (edge LID, vertex LID, side) for each half edge. The vertex is the one
+    //! inside the subdomain, the side (0 or 1) its position in the edge's
+    //! vertex tuple.
+    std::vector<std::array<int,3>> half_edge_table;
+    //! Edges and half edges grouped into colors such that no two of the same
+    //! color touch the same vertex row, for thread-parallel assembly. Item k
+    //! is edge_table[k] for k < edge_table.size(), otherwise
+    //! half_edge_table[k - edge_table.size()]. Color c consists of
+    //! color_items[color_ptrs[c]] to color_items[color_ptrs[c+1] - 1].
+    //! (Only built with OpenMP or Kokkos.)
+    std::vector<int> color_ptrs;
+    std::vector<int> color_items;
+    //! Membership bitsets over the local vertex and edge IDs, 64 per word.
+    //! (Half edges aren't members.)
+    std::vector<std::uint64_t> vertex_bits;
+    std::vector<std::uint64_t> edge_bits;
+
+    bool
+    contains_vertex(const int lid) const
+    {
+      return (vertex_bits[lid >> 6] >> (lid & 63)) & 1;
+    }
+
+    bool
+    contains_edge(const int lid) const
+    {
+      return (edge_bits[lid >> 6] >> (lid & 63)) & 1;
+    }
+  };
+
+  //! Positions of entries in the local values array of a matrix on
+  //! overlap_graph().
+  struct crs_offsets {
+    //! (v0,v0), (v0,v1), (v1,v0), (v1,v1) for each edge with vertices v0, v1
+    std::vector<std::array<size_t,4>> edges;
+    //! The diagonal entry of each local vertex. Invalid for vertices that
+    //! aren't owned such that vertex terms are added only once.
+    std::vector<size_t> diagonals;
+  };
+
+  //! Positions of entries in the local values array of a matrix on
+  //! overlap_complex_graph().
+  struct complex_crs_offsets {
+    //! The 4x4 block of each edge, row-major, with rows and columns ordered as
+    //! in edge_lids_complex.
+    std::vector<std::array<size_t,16>> edges;
+  };
+
 public:
+  //! If a loaded cache is given, the preprocessed data is taken from there
+  //! instead of being recomputed.
   mesh(
       std::shared_ptr<const Teuchos::Comm<int>>  _comm,
       std::shared_ptr<moab::ParallelComm>  mcomm,
-      const std::shared_ptr<moab::Core> & mb
+      const std::shared_ptr<moab::Core> & mb,
+      const std::shared_ptr<const mesh_cache> & cache = nullptr
       );
 
   virtual
   ~mesh();
 
+  //! Put all preprocessed data into the cache, cf. mesh_cache::write().
+  void
+  write_cache(mesh_cache & cache) const;
+
   void
   mark_subdomains(const std::set<std::shared_ptr<nosh::subdomain>> & subdomains);
 
@@ -70,6 +159,9 @@ public:
   moab::Range
   get_vertex_tuple(const moab::EntityHandle & edge) const;
 
+  const subdomain_tables &
+  get_subdomain_tables(const std::string & subdomain_id) const;
+
   bool
   contains(
       const std::string & subdomain_id,
@@ -167,6 +259,69 @@ public:
   Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
   build_complex_graph() const;
 
+  //! The vertex graph, built on first use and shared by all matrices
+  //! constructed from it. (Collective on first call.)
+  Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+  graph() const;
+
+  //! The complex (2x2-expanded) vertex graph, built on first use and shared by
+  //! all matrices constructed from it. (Collective on first call.)
+  Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+  complex_graph() const;
+
+  //! Whether some local vertices aren't owned by this process, i.e.,
+  //! overlap_map() differs from map(). (Determined once on construction,
+  //! comparing the maps is collective.)
+  bool
+  is_distributed() const
+  {
+    return is_distributed_;
+  }
+
+  //! The vertex graph on the overlap map, i.e., with the rows of all local
+  //! vertices. It serves for local assembly prior to an export to graph().
+  //! (Same as graph() if all local vertices are owned.)
+  Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+  overlap_graph() const;
+
+  //! Positions of the edge and vertex entries in matrices on
+  //! overlap_graph(), built on first use and shared.
+  const crs_offsets &
+  overlap_crs_offsets() const;
+
+  //! The complex graph on the overlap complex map, for local assembly prior
+  //! to an export to complex_graph(). (Same as complex_graph() if all local
+  //! vertices are owned.)
+  Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+  overlap_complex_graph() const;
+
+  //! Positions of the edge entries in matrices on overlap_complex_graph(),
+  //! built on first use and shared.
+  const complex_crs_offsets &
+  overlap_complex_crs_offsets() const;
+
+  //! Import from map() to overlap_map(), e.g., for distributing owned values
+  //! to all local vertices. Built on first use and shared. (Collective on
+  //! first call.)
+  Teuchos::RCP<const Tpetra::Import<int,int>>
+  importer() const;
+
+  //! Export from overlap_map() to map(), e.g., for summing up local
+  //! contributions on the owners. Built on first use and shared. (Collective
+  //! on first call.)
+  Teuchos::RCP<const Tpetra::Export<int,int>>
+  exporter() const;
+
+  //! Import from complex_map() to overlap_complex_map(). (Collective on first
+  //! call.)
+  Teuchos::RCP<const Tpetra::Import<int,int>>
+  complex_importer() const;
+
+  //! Export from overlap_complex_map() to complex_map(). (Collective on first
+  //! call.)
+  Teuchos::RCP<const Tpetra::Export<int,int>>
+  complex_exporter() const;
+
   void
   insert_vector(
       const Tpetra::Vector<double,int,int> &x,
@@ -184,6 +339,12 @@ public:
       const moab::EntityHandle vertex
       ) const;
 
+  const vertex_coordinates &
+  vertex_coords() const
+  {
+    return vertex_coords_;
+  }
+
 public:
   virtual
   std::shared_ptr<const Tpetra::Vector<double,int,int>>
@@ -209,7 +370,22 @@ private:
       const std::vector<moab::EntityHandle> & boundary_skin
       ) const;
 
+  subdomain_tables
+  build_subdomain_tables_(const std::string & subdomain_id) const;
+
+  //! Fills the index tables of a subdomain from its membership bitsets.
+  void
+  fill_subdomain_tables_(
+      subdomain_tables & tables,
+      const std::vector<std::uint64_t> & half_edge_bits
+      ) const;
+
 protected:
+  //! Number of cells the vectorized geometry kernels process at once.
+  static const int batch_size_ = 64;
+
+  //! One value per cell in a batch; structure-of-arrays layout.
+  typedef Eigen::Array<double, batch_size_, 1> batch_array;
 
   Eigen::Vector3d
   compute_triangle_circumcenter_(
@@ -223,11 +399,92 @@ protected:
       const Eigen::Vector3d &node2
       ) const;
 
-  std::vector<double>
+  std::array<double,3>
   compute_triangle_splitting_(
-      const std::vector<moab::EntityHandle> & conn
+      const int i0,
+      const int i1,
+      const int i2
       ) const;
 
+  //! Control volumes from cache_, distributed on map().
+  std::shared_ptr<Tpetra::Vector<double,int,int>>
+  get_cached_control_volumes_() const;
+
+  //! Local IDs of the vertices of the given entities, with the number of
+  //! vertices per entity as stride.
+  std::vector<int>
+  get_connectivity_lids_(
+      const std::vector<moab::EntityHandle> & entities
+      ) const;
+
+  //! Calls f(k, partial) for all k in [0, n) and returns the sum of all
+  //! partials, arrays of length m.
+  //! With OpenMP, the calls are distributed among the threads and every
+  //! thread adds into its own partial. Those are summed up in thread order
+  //! afterwards such that, for a given number of threads, the result doesn't
+  //! depend on the scheduling.
+  //! MOAB isn't thread-safe, so f should only work on data fetched
+  //! beforehand.
+  template<typename F>
+  std::vector<double>
+  parallel_sum_(const size_t n, const size_t m, const F & f) const
+  {
+#ifdef NOSH_OPENMP
+    const int num_threads = omp_get_max_threads();
+#else
+    const int num_threads = 1;
+#endif
+    std::vector<std::vector<double>> partials(num_threads);
+    std::exception_ptr error = nullptr;
+
+#ifdef NOSH_OPENMP
+#pragma omp parallel num_threads(num_threads)
+#endif
+    {
+#ifdef NOSH_OPENMP
+      const int t = omp_get_thread_num();
+#else
+      const int t = 0;
+#endif
+      // Let every thread allocate its own partial (first touch).
+      partials[t].resize(m, 0.0);
+      double * partial = partials[t].data();
+#ifdef NOSH_OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (long k = 0; k < static_cast<long>(n); k++) {
+        // Exceptions must not leave the parallel region.
+        try {
+          f(k, partial);
+        } catch (...) {
+#ifdef NOSH_OPENMP
+#pragma omp critical
+#endif
+          error = std::current_exception();
+        }
+      }
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+
+    std::vector<double> & sum = partials[0];
+#ifdef NOSH_OPENMP
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+#endif
+    for (long i = 0; i < static_cast<long>(m); i++) {
+      for (int t = 1; t < num_threads; t++) {
+        // The runtime may have provided fewer threads than requested.
+        if (!partials[t].empty()) {
+          sum[i] += partials[t][i];
+        }
+      }
+    }
+
+    return std::move(sum);
+  }
+
 private:
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   const Teuchos::RCP<Teuchos::Time> write_time_;
@@ -240,6 +497,11 @@ public:
 
 protected:
   const std::shared_ptr<moab::ParallelComm> mcomm_;
+  //! Only set during construction.
+  std::shared_ptr<const mesh_cache> cache_;
+
+private:
+  const vertex_coordinates vertex_coords_;
 
 protected:
   const std::shared_ptr<const Tpetra::Map<int,int>> vertices_map_;
@@ -248,6 +510,7 @@ protected:
 private:
   const std::shared_ptr<const Tpetra::Map<int,int>> complex_map_;
   const std::shared_ptr<const Tpetra::Map<int,int>> complex_overlap_map_;
+  const bool is_distributed_;
 
 protected:
   const entity_relations relations_;
@@ -266,6 +529,18 @@ public:
 
 private:
   std::map<std::string, moab::EntityHandle> meshsets_;
+  std::map<std::string, subdomain_tables> subdomain_tables_;
+
+  mutable Teuchos::RCP<const Tpetra::CrsGraph<int,int>> graph_;
+  mutable Teuchos::RCP<const Tpetra::CrsGraph<int,int>> complex_graph_;
+  mutable Teuchos::RCP<const Tpetra::CrsGraph<int,int>> overlap_graph_;
+  mutable std::shared_ptr<const crs_offsets> overlap_crs_offsets_;
+  mutable Teuchos::RCP<const Tpetra::CrsGraph<int,int>> overlap_complex_graph_;
+  mutable std::shared_ptr<const complex_crs_offsets> overlap_complex_crs_offsets_;
+  mutable Teuchos::RCP<const Tpetra::Import<int,int>> importer_;
+  mutable Teuchos::RCP<const Tpetra::Export<int,int>> exporter_;
+  mutable Teuchos::RCP<const Tpetra::Import<int,int>> complex_importer_;
+  mutable Teuchos::RCP<const Tpetra::Export<int,int>> complex_exporter_;
 
 private:
   const std::vector<Teuchos::Tuple<int,2>>
@@ -289,9 +564,26 @@ private:
   std::vector<edge_data>
   compute_edge_data_() const;
 
+  void
+  build_local_crs_(
+      const int block_size,
+      Teuchos::ArrayRCP<size_t> & row_ptrs,
+      Teuchos::ArrayRCP<int> & col_idx
+      ) const;
+
+  Teuchos::RCP<const Tpetra::CrsGraph<int,int>>
+  build_graph_from_local_crs_(
+      const std::shared_ptr<const Tpetra::Map<int,int>> & map,
+      const std::shared_ptr<const Tpetra::Map<int,int>> & overlap_map,
+      const int block_size
+      ) const;
+
   std::shared_ptr<const Tpetra::Map<int,int>>
   build_map_(const std::vector<moab::EntityHandle> &entityList) const;
 
+  vertex_coordinates
+  build_vertex_coords_() const;
+
   entity_relations
   build_entity_relations_();
 
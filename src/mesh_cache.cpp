@@ -0,0 +1,254 @@
+#include "mesh_cache.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nosh
+{
+// File layout:
+//
+//   magic (8 bytes), content hash, number of partitions, rank, number of
+//   arrays (8 bytes each),
+//   for each array: name length, name, element size, offset, size in bytes,
+//   the arrays, each aligned to 64 bytes.
+//
+// All integers are stored in native byte order; the cache is meant to be
+// read back on the same machine.
+static const char cache_magic[8] = {'N', 'O', 'S', 'H', 'M', 'C', '0', '1'};
+static const std::uint64_t cache_alignment = 64;
+// =============================================================================
+mesh_cache::
+mesh_cache(
+    const std::string & file_name,
+    const std::uint64_t content_hash,
+    const int num_procs,
+    const int rank
+    ) :
+  file_name_(file_name),
+  content_hash_(content_hash),
+  num_procs_(num_procs),
+  rank_(rank),
+  data_(nullptr),
+  size_(0),
+  entries_(),
+  staged_()
+{
+  this->load_();
+}
+// =============================================================================
+mesh_cache::
+~mesh_cache()
+{
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+// =============================================================================
+void
+mesh_cache::
+load_()
+{
+  const int fd = open(file_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    // no cache file (yet)
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return;
+  }
+  size_ = st.st_size;
+
+  void * data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the file descriptor.
+  close(fd);
+  if (data == MAP_FAILED) {
+    size_ = 0;
+    return;
+  }
+
+  // Parse the header. Anything unexpected invalidates the entire cache.
+  const char * bytes = static_cast<const char*>(data);
+  std::size_t pos = 0;
+  const auto read_u64 = [&](std::uint64_t & value) {
+    if (pos + sizeof(value) > size_) {
+      return false;
+    }
+    std::memcpy(&value, bytes + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+  };
+
+  bool valid = size_ >= sizeof(cache_magic)
+    && std::memcmp(bytes, cache_magic, sizeof(cache_magic)) == 0;
+  pos = sizeof(cache_magic);
+
+  std::uint64_t hash = 0;
+  std::uint64_t num_procs = 0;
+  std::uint64_t rank = 0;
+  std::uint64_t num_entries = 0;
+  valid = valid
+    && read_u64(hash) && hash == content_hash_
+    && read_u64(num_procs) && num_procs == std::uint64_t(num_procs_)
+    && read_u64(rank) && rank == std::uint64_t(rank_)
+    && read_u64(num_entries);
+
+  for (std::uint64_t k = 0; valid && k < num_entries; k++) {
+    std::uint64_t name_length = 0;
+    valid = read_u64(name_length) && pos + name_length <= size_;
+    if (!valid) {
+      break;
+    }
+    const std::string name(bytes + pos, name_length);
+    pos += name_length;
+
+    entry e;
+    valid = read_u64(e.elem_size)
+      && read_u64(e.offset)
+      && read_u64(e.size)
+      && e.offset <= size_
+      && e.size <= size_ - e.offset;
+    if (valid) {
+      entries_[name] = e;
+    }
+  }
+
+  if (!valid) {
+    munmap(data, size_);
+    size_ = 0;
+    entries_.clear();
+    return;
+  }
+
+  data_ = data;
+  return;
+}
+// =============================================================================
+void
+mesh_cache::
+write() const
+{
+  // Compute the size of the header and the array offsets.
+  std::uint64_t header_size = sizeof(cache_magic) + 4 * sizeof(std::uint64_t);
+  for (const auto & array: staged_) {
+    header_size += 4 * sizeof(std::uint64_t) + array.first.size();
+  }
+
+  std::vector<std::uint64_t> offsets;
+  std::uint64_t offset = header_size;
+  for (const auto & array: staged_) {
+    offset = (offset + cache_alignment - 1) / cache_alignment * cache_alignment;
+    offsets.push_back(offset);
+    offset += array.second.bytes.size();
+  }
+
+  // Write to a temporary file first such that concurrent readers never see a
+  // partially written cache.
+  const std::string tmp_file_name = file_name_ + ".tmp";
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        !out,
+        "Could not open mesh cache file " << tmp_file_name << " for writing."
+        );
+
+    const auto write_u64 = [&](const std::uint64_t value) {
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    out.write(cache_magic, sizeof(cache_magic));
+    write_u64(content_hash_);
+    write_u64(num_procs_);
+    write_u64(rank_);
+    write_u64(staged_.size());
+    size_t k = 0;
+    for (const auto & array: staged_) {
+      write_u64(array.first.size());
+      out.write(array.first.data(), array.first.size());
+      write_u64(array.second.elem_size);
+      write_u64(offsets[k]);
+      write_u64(array.second.bytes.size());
+      k++;
+    }
+
+    k = 0;
+    std::uint64_t pos = header_size;
+    const std::vector<char> padding(cache_alignment, 0);
+    for (const auto & array: staged_) {
+      out.write(padding.data(), offsets[k] - pos);
+      out.write(array.second.bytes.data(), array.second.bytes.size());
+      pos = offsets[k] + array.second.bytes.size();
+      k++;
+    }
+
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        !out,
+        "Error writing mesh cache file " << tmp_file_name << "."
+        );
+  }
+
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      std::rename(tmp_file_name.c_str(), file_name_.c_str()) != 0,
+      "Could not rename " << tmp_file_name << " to " << file_name_ << "."
+      );
+
+  return;
+}
+// =============================================================================
+std::uint64_t
+mesh_cache::
+hash_file(const std::string & file_name)
+{
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      fd < 0,
+      "Could not open " << file_name << "."
+      );
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(true, "Could not stat " << file_name << ".");
+  }
+  const std::size_t size = st.st_size;
+
+  // FNV-1a, consuming 64-bit words
+  const std::uint64_t prime = 1099511628211ULL;
+  std::uint64_t hash = 14695981039346656037ULL;
+  hash = (hash ^ size) * prime;
+  if (size == 0) {
+    close(fd);
+    return hash;
+  }
+
+  void * data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      data == MAP_FAILED,
+      "Could not map " << file_name << "."
+      );
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  const char * bytes = static_cast<const char*>(data);
+  const std::size_t num_words = size / sizeof(std::uint64_t);
+  for (std::size_t k = 0; k < num_words; k++) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + k * sizeof(word), sizeof(word));
+    hash = (hash ^ word) * prime;
+  }
+  for (std::size_t k = num_words * sizeof(std::uint64_t); k < size; k++) {
+    hash = (hash ^ static_cast<unsigned char>(bytes[k])) * prime;
+  }
+
+  munmap(data, size);
+  return hash;
+}
+// =============================================================================
+} // namespace nosh
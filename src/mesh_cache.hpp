@@ -0,0 +1,136 @@
+#ifndef NOSH_MESHCACHE_HPP
+#define NOSH_MESHCACHE_HPP
+// =============================================================================
+// includes
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Teuchos_TestForException.hpp>
+
+namespace nosh
+{
+//! Sidecar file holding the preprocessed mesh data (entity relations, edge
+//! IDs, edge data, control volumes, ...) of one partition of a mesh file.
+//!
+//! The file is keyed by the content hash of the mesh file, the number of
+//! partitions, and the rank. A file that doesn't match the key is ignored.
+//! A matching file is memory-mapped on construction, and the named arrays are
+//! read from the mapping with get(). New arrays are collected with put() and
+//! written with write().
+class mesh_cache
+{
+public:
+  mesh_cache(
+      const std::string & file_name,
+      const std::uint64_t content_hash,
+      const int num_procs,
+      const int rank
+      );
+
+  ~mesh_cache();
+
+  mesh_cache(const mesh_cache &) = delete;
+  mesh_cache & operator=(const mesh_cache &) = delete;
+
+  //! Whether a matching cache file was found.
+  bool
+  is_loaded() const
+  {
+    return data_ != nullptr;
+  }
+
+  bool
+  contains(const std::string & name) const
+  {
+    return entries_.count(name) > 0;
+  }
+
+  template<typename T>
+  std::vector<T>
+  get(const std::string & name) const
+  {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Only trivially copyable types can be cached."
+        );
+    const auto it = entries_.find(name);
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        it == entries_.end(),
+        "Array \"" << name << "\" not found in mesh cache " << file_name_ << "."
+        );
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        it->second.elem_size != sizeof(T) || it->second.size % sizeof(T) != 0,
+        "Array \"" << name << "\" in mesh cache " << file_name_
+        << " has the wrong element size."
+        );
+    std::vector<T> data(it->second.size / sizeof(T));
+    if (!data.empty()) {
+      std::memcpy(
+          data.data(),
+          static_cast<const char*>(data_) + it->second.offset,
+          it->second.size
+          );
+    }
+    return data;
+  }
+
+  template<typename T>
+  void
+  put(const std::string & name, const std::vector<T> & data)
+  {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Only trivially copyable types can be cached."
+        );
+    auto & buffer = staged_[name];
+    buffer.elem_size = sizeof(T);
+    buffer.bytes.resize(data.size() * sizeof(T));
+    if (!data.empty()) {
+      std::memcpy(buffer.bytes.data(), data.data(), buffer.bytes.size());
+    }
+  }
+
+  //! Write all arrays given to put() to the cache file.
+  void
+  write() const;
+
+  //! Hash of the contents of a file (FNV-1a over 64-bit words).
+  static
+  std::uint64_t
+  hash_file(const std::string & file_name);
+
+private:
+  void
+  load_();
+
+private:
+  struct entry {
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint64_t elem_size;
+  };
+
+  struct staged_array {
+    std::uint64_t elem_size;
+    std::vector<char> bytes;
+  };
+
+  const std::string file_name_;
+  const std::uint64_t content_hash_;
+  const std::int64_t num_procs_;
+  const std::int64_t rank_;
+
+  void * data_;
+  std::size_t size_;
+  std::map<std::string, entry> entries_;
+
+  std::map<std::string, staged_array> staged_;
+};
+
+} // namespace nosh
+// =============================================================================
+#endif // NOSH_MESHCACHE_HPP
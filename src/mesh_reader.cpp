@@ -10,6 +10,8 @@
 #include <moab/ParallelComm.hpp>
 #include <MBParallelConventions.h>
 
+#include "mesh_cache.hpp"
+#include "mesh_reordering.hpp"
 #include "mesh_tri.hpp"
 #include "mesh_tetra.hpp"
 #include "moab_wrap.hpp"
@@ -17,7 +19,11 @@
 namespace nosh
 {
 std::shared_ptr<nosh::mesh>
-read(const std::string & file_name)
+read(
+    const std::string & file_name,
+    const bool use_cache,
+    const std::string & vertex_ordering
+    )
 {
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   const auto fill_time =
@@ -72,8 +78,50 @@ read(const std::string & file_name)
   }
 #endif
 
-  // Read the file with the specified options
-  mbw->load_file(file_name, 0, options);
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      vertex_ordering != "file"
+      && vertex_ordering != "rcm"
+      && vertex_ordering != "morton",
+      "Unknown vertex ordering \"" << vertex_ordering << "\". "
+      << "Valid orderings are \"file\", \"rcm\", and \"morton\"."
+      );
+
+  if (vertex_ordering == "file") {
+    // Read the file with the specified options
+    mbw->load_file(file_name, 0, options);
+  } else {
+    // Read the partition into a scratch instance and copy it over in the new
+    // order. The shared entities are resolved only after that since the
+    // resolution tags the entities of the instance it works on.
+    auto scratch = std::make_shared<moab_wrap>(std::make_shared<moab::Core>());
+    const auto scratch_comm =
+      std::make_shared<moab::ParallelComm>(scratch->mb.get(), raw_comm);
+    scratch->load_file(
+        file_name,
+        0,
+        (comm->getSize() == 1) ?
+        "" :
+        "PARALLEL=READ_PART;PARTITION=PARALLEL_PARTITION"
+        );
+    reorder_mesh(*scratch, *mbw, vertex_ordering);
+
+    if (comm->getSize() > 1) {
+      // Register the copied partition set as a parallel read does.
+      moab::Tag part_tag;
+      auto rval = mbw->mb->tag_get_handle(PARALLEL_PARTITION_TAG_NAME, part_tag);
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+      rval = mbw->mb->get_entities_by_type_and_tag(
+          0, moab::MBENTITYSET, &part_tag, nullptr, 1,
+          mcomm->partition_sets()
+          );
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+
+      const int dim =
+        (mbw->get_number_entities_by_dimension(0, 3) > 0) ? 3 : 2;
+      rval = mcomm->resolve_shared_ents(0, dim, 1);
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+    }
+  }
 
   moab::ErrorCode rval;
   moab::Range shared_ents;
@@ -154,11 +202,42 @@ read(const std::string & file_name)
   }
 #endif
 
+  std::shared_ptr<nosh::mesh_cache> cache = nullptr;
+  if (use_cache) {
+    // Only one process reads through the entire file for the hash.
+    std::uint64_t content_hash = 0;
+    if (global_rank == 0) {
+      content_hash = nosh::mesh_cache::hash_file(file_name);
+    }
+    MPI_Bcast(&content_hash, 1, MPI_UINT64_T, 0, raw_comm);
+
+    cache = std::make_shared<nosh::mesh_cache>(
+        file_name + ".cache-" +
+        (vertex_ordering == "file" ? "" : vertex_ordering + "-") +
+        std::to_string(nprocs) +
+        "-" + std::to_string(global_rank),
+        content_hash,
+        nprocs,
+        global_rank
+        );
+    std::cout << "Mesh cache " << (cache->is_loaded() ? "found" : "not found")
+      << "." << std::endl;
+  }
+
   std::cout << "   mesh_reader >>" << std::endl;
+  std::shared_ptr<nosh::mesh> mesh;
   if (numTets == 0) {
-    return std::make_shared<nosh::mesh_tri>(comm, mcomm, mbw->mb);
+    mesh = std::make_shared<nosh::mesh_tri>(comm, mcomm, mbw->mb, cache);
+  } else {
+    mesh = std::make_shared<nosh::mesh_tetra>(comm, mcomm, mbw->mb, cache);
   }
-  return std::make_shared<nosh::mesh_tetra>(comm, mcomm, mbw->mb);
+
+  if (cache && !cache->is_loaded()) {
+    mesh->write_cache(*cache);
+    cache->write();
+  }
+
+  return mesh;
 }
 
 }  // namespace nosh
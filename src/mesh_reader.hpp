@@ -11,8 +11,20 @@
 namespace nosh
 {
 
+//! Reads a mesh file. With use_cache, the preprocessed mesh data is stored in
+//! a sidecar file next to the mesh file (one per partition) and taken from
+//! there on later reads of the same mesh.
+//!
+//! vertex_ordering selects the numbering of the vertices: "file" keeps the
+//! order of the mesh file, "rcm" (reverse Cuthill-McKee) and "morton"
+//! (Z-order curve) renumber the vertices for locality. Cells and edges are
+//! then sorted by their vertices.
 std::shared_ptr<nosh::mesh>
-read(const std::string & file_name);
+read(
+    const std::string & file_name,
+    const bool use_cache = false,
+    const std::string & vertex_ordering = "file"
+    );
 
 } // namespace nosh
 // =============================================================================
@@ -0,0 +1,546 @@
+#include "mesh_reordering.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <utility>
+
+#include <MBParallelConventions.h>
+#include <MBTagConventions.hpp>
+#include <moab/ReadUtilIface.hpp>
+
+#include <Teuchos_TestForException.hpp>
+
+namespace nosh
+{
+// =============================================================================
+std::vector<int>
+reverse_cuthill_mckee(
+    const std::vector<int> & row_ptrs,
+    const std::vector<int> & cols
+    )
+{
+  const int n = row_ptrs.size() - 1;
+
+  std::vector<int> degree(n);
+  for (int i = 0; i < n; i++) {
+    degree[i] = row_ptrs[i+1] - row_ptrs[i];
+  }
+
+  // Start vertices are taken in order of increasing degree.
+  std::vector<int> by_degree(n);
+  std::iota(by_degree.begin(), by_degree.end(), 0);
+  std::stable_sort(
+      by_degree.begin(),
+      by_degree.end(),
+      [&](const int a, const int b) { return degree[a] < degree[b]; }
+      );
+
+  std::vector<bool> visited(n, false);
+  std::vector<int> level(n, -1);
+  std::vector<int> order;
+  order.reserve(n);
+
+  // Breadth-first search from start among the unvisited vertices. Returns
+  // the vertices in the order visited; level holds their distances.
+  std::vector<int> bfs;
+  const auto level_structure = [&](const int start) {
+    for (const int v: bfs) {
+      level[v] = -1;
+    }
+    bfs.clear();
+    bfs.push_back(start);
+    level[start] = 0;
+    for (size_t k = 0; k < bfs.size(); k++) {
+      const int v = bfs[k];
+      for (int j = row_ptrs[v]; j < row_ptrs[v+1]; j++) {
+        const int w = cols[j];
+        if (!visited[w] && level[w] < 0) {
+          level[w] = level[v] + 1;
+          bfs.push_back(w);
+        }
+      }
+    }
+  };
+
+  std::vector<int> neighbors;
+  for (const int seed: by_degree) {
+    if (visited[seed]) {
+      continue;
+    }
+
+    // Find a pseudo-peripheral start vertex of this component (George-Liu):
+    // Move to a vertex of minimal degree in the last level as long as this
+    // increases the depth of the level structure.
+    int start = seed;
+    level_structure(start);
+    int depth = level[bfs.back()];
+    for (int it = 0; it < 10; it++) {
+      int candidate = bfs.back();
+      for (auto k = bfs.rbegin(); k != bfs.rend() && level[*k] == depth; ++k) {
+        if (degree[*k] < degree[candidate]) {
+          candidate = *k;
+        }
+      }
+      level_structure(candidate);
+      const int new_depth = level[bfs.back()];
+      if (new_depth <= depth) {
+        level_structure(start);
+        break;
+      }
+      start = candidate;
+      depth = new_depth;
+    }
+
+    // Cuthill-McKee: breadth-first, neighbors in order of increasing degree
+    const size_t begin = order.size();
+    order.push_back(start);
+    visited[start] = true;
+    for (size_t k = begin; k < order.size(); k++) {
+      const int v = order[k];
+      neighbors.clear();
+      for (int j = row_ptrs[v]; j < row_ptrs[v+1]; j++) {
+        if (!visited[cols[j]]) {
+          neighbors.push_back(cols[j]);
+          visited[cols[j]] = true;
+        }
+      }
+      std::stable_sort(
+          neighbors.begin(),
+          neighbors.end(),
+          [&](const int a, const int b) { return degree[a] < degree[b]; }
+          );
+      order.insert(order.end(), neighbors.begin(), neighbors.end());
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+// =============================================================================
+std::vector<int>
+morton_order(
+    const std::vector<double> & x,
+    const std::vector<double> & y,
+    const std::vector<double> & z
+    )
+{
+  const size_t n = x.size();
+  if (n == 0) {
+    return {};
+  }
+
+  // Quantize the coordinates in the bounding box to 21 bits each.
+  const std::array<const std::vector<double>*, 3> coords = {{&x, &y, &z}};
+  std::array<double, 3> lower;
+  std::array<double, 3> scale;
+  for (int d = 0; d < 3; d++) {
+    const auto minmax =
+      std::minmax_element(coords[d]->begin(), coords[d]->end());
+    lower[d] = *minmax.first;
+    const double extent = *minmax.second - *minmax.first;
+    scale[d] = (extent > 0.0) ? ((1 << 21) - 1) / extent : 0.0;
+  }
+
+  // Spread the lower 21 bits of v such that there are two zero bits between
+  // every two bits.
+  const auto spread = [](std::uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+  };
+
+  std::vector<std::uint64_t> codes(n);
+  for (size_t k = 0; k < n; k++) {
+    std::uint64_t code = 0;
+    for (int d = 0; d < 3; d++) {
+      const auto q = static_cast<std::uint64_t>(
+          ((*coords[d])[k] - lower[d]) * scale[d] + 0.5
+          );
+      code |= spread(q) << d;
+    }
+    codes[k] = code;
+  }
+
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+      order.begin(),
+      order.end(),
+      [&](const int a, const int b) { return codes[a] < codes[b]; }
+      );
+  return order;
+}
+// =============================================================================
+void
+reorder_mesh(
+    moab_wrap & source,
+    moab_wrap & target,
+    const std::string & vertex_ordering
+    )
+{
+  moab::ErrorCode rval;
+
+  const int dim =
+    (source.get_number_entities_by_dimension(0, 3) > 0) ? 3 : 2;
+  const moab::Range cells = source.get_entities_by_dimension(0, dim);
+  const moab::Range verts = source.get_entities_by_dimension(0, 0);
+  const int num_verts = verts.size();
+  const int num_cells = cells.size();
+  const int num_corners = dim + 1;
+
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      num_cells > 0 &&
+      source.mb->type_from_handle(cells.front()) !=
+      source.mb->type_from_handle(cells.back()),
+      "Mesh reordering only supports meshes with one cell type."
+      );
+
+  // Cell connectivity as vertex indices into verts
+  int verts_per_cell = 0;
+  const auto conn = source.connect_iterate(cells, verts_per_cell);
+  std::vector<int> cell_verts(conn.size());
+  for (size_t k = 0; k < conn.size(); k++) {
+    cell_verts[k] = verts.index(conn[k]);
+  }
+
+  const auto coords = source.get_coords(verts);
+
+  // Compute the new vertex order.
+  std::vector<int> vertex_order;
+  if (vertex_ordering == "rcm") {
+    // vertex adjacency graph from the cell edges
+    std::vector<int> row_ptrs(num_verts + 1, 0);
+    for (int c = 0; c < num_cells; c++) {
+      const int * cv = &cell_verts[verts_per_cell * c];
+      for (int i = 0; i < num_corners; i++) {
+        row_ptrs[cv[i] + 1] += num_corners - 1;
+      }
+    }
+    std::partial_sum(row_ptrs.begin(), row_ptrs.end(), row_ptrs.begin());
+    std::vector<int> cols(row_ptrs.back());
+    std::vector<int> pos(row_ptrs.begin(), row_ptrs.end() - 1);
+    for (int c = 0; c < num_cells; c++) {
+      const int * cv = &cell_verts[verts_per_cell * c];
+      for (int i = 0; i < num_corners; i++) {
+        for (int j = 0; j < num_corners; j++) {
+          if (i != j) {
+            cols[pos[cv[i]]++] = cv[j];
+          }
+        }
+      }
+    }
+    // Make the rows unique and compress.
+    std::vector<int> unique_ptrs(num_verts + 1, 0);
+    size_t l = 0;
+    for (int i = 0; i < num_verts; i++) {
+      const auto begin = cols.begin() + row_ptrs[i];
+      const auto end = cols.begin() + row_ptrs[i+1];
+      std::sort(begin, end);
+      const auto unique_end = std::unique(begin, end);
+      l = std::copy(begin, unique_end, cols.begin() + l) - cols.begin();
+      unique_ptrs[i+1] = l;
+    }
+    cols.resize(l);
+    vertex_order = reverse_cuthill_mckee(unique_ptrs, cols);
+  } else if (vertex_ordering == "morton") {
+    vertex_order = morton_order(coords[0], coords[1], coords[2]);
+  } else {
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        true,
+        "Unknown vertex ordering \"" << vertex_ordering << "\". "
+        << "Valid orderings are \"rcm\" and \"morton\"."
+        );
+  }
+
+  std::vector<int> new_index(num_verts);
+  for (int k = 0; k < num_verts; k++) {
+    new_index[vertex_order[k]] = k;
+  }
+
+  // Sort the cells by their smallest new vertex index.
+  std::vector<int> cell_min(num_cells);
+  for (int c = 0; c < num_cells; c++) {
+    int m = num_verts;
+    for (int i = 0; i < num_corners; i++) {
+      m = std::min(m, new_index[cell_verts[verts_per_cell * c + i]]);
+    }
+    cell_min[c] = m;
+  }
+  std::vector<int> cell_order(num_cells);
+  std::iota(cell_order.begin(), cell_order.end(), 0);
+  std::stable_sort(
+      cell_order.begin(),
+      cell_order.end(),
+      [&](const int a, const int b) { return cell_min[a] < cell_min[b]; }
+      );
+
+  // Create the vertices and elements in bulk.
+  moab::ReadUtilIface * iface = nullptr;
+  rval = target.mb->query_interface(iface);
+  TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+
+  moab::EntityHandle vert_start;
+  std::vector<double*> arrays;
+  rval = iface->get_node_coords(3, num_verts, 0, vert_start, arrays);
+  TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+  for (int k = 0; k < num_verts; k++) {
+    for (int d = 0; d < 3; d++) {
+      arrays[d][k] = coords[d][vertex_order[k]];
+    }
+  }
+
+  const moab::EntityType cell_type = num_cells > 0 ?
+    source.mb->type_from_handle(cells.front()) :
+    (dim == 3 ? moab::MBTET : moab::MBTRI);
+  moab::EntityHandle cell_start = 0;
+  if (num_cells > 0) {
+    moab::EntityHandle * cell_conn = nullptr;
+    rval = iface->get_element_connect(
+        num_cells, verts_per_cell, cell_type, 0, cell_start, cell_conn
+        );
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+    for (int c = 0; c < num_cells; c++) {
+      for (int i = 0; i < verts_per_cell; i++) {
+        cell_conn[verts_per_cell * c + i] = vert_start +
+          new_index[cell_verts[verts_per_cell * cell_order[c] + i]];
+      }
+    }
+    rval = iface->update_adjacencies(
+        cell_start, num_cells, verts_per_cell, cell_conn
+        );
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+  }
+
+  // Create the edges, sorted by their (new) vertex indices, before anyone
+  // else creates them in cell order.
+  std::vector<std::pair<int, int>> edges;
+  edges.reserve(num_cells * num_corners * (num_corners - 1) / 2);
+  for (int c = 0; c < num_cells; c++) {
+    const int * cv = &cell_verts[verts_per_cell * c];
+    for (int i = 0; i < num_corners; i++) {
+      for (int j = i + 1; j < num_corners; j++) {
+        const int a = new_index[cv[i]];
+        const int b = new_index[cv[j]];
+        edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  moab::EntityHandle edge_start = 0;
+  if (!edges.empty()) {
+    moab::EntityHandle * edge_conn = nullptr;
+    rval = iface->get_element_connect(
+        edges.size(), 2, moab::MBEDGE, 0, edge_start, edge_conn
+        );
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+    for (size_t k = 0; k < edges.size(); k++) {
+      edge_conn[2*k] = vert_start + edges[k].first;
+      edge_conn[2*k + 1] = vert_start + edges[k].second;
+    }
+    rval = iface->update_adjacencies(edge_start, edges.size(), 2, edge_conn);
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+  }
+
+  rval = target.mb->release_interface(iface);
+  TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+
+  // Copy the vertex and cell tags (including GLOBAL_ID) in the new order.
+  std::vector<moab::EntityHandle> old_verts(num_verts);
+  for (int k = 0; k < num_verts; k++) {
+    old_verts[k] = verts[vertex_order[k]];
+  }
+  std::vector<moab::EntityHandle> old_cells(num_cells);
+  for (int c = 0; c < num_cells; c++) {
+    old_cells[c] = cells[cell_order[c]];
+  }
+  const moab::Range new_verts(vert_start, vert_start + num_verts - 1);
+  const moab::Range new_cells = num_cells > 0 ?
+    moab::Range(cell_start, cell_start + num_cells - 1) :
+    moab::Range();
+
+  // source tag -> target tag, for the entity sets below
+  std::vector<std::pair<moab::Tag, moab::Tag>> copied_tags;
+
+  std::vector<moab::Tag> tags;
+  rval = source.mb->tag_get_tags(tags);
+  TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+  for (const auto & tag: tags) {
+    std::string name;
+    moab::DataType data_type;
+    moab::TagType tag_type;
+    int length;
+    int bytes;
+    if (source.mb->tag_get_name(tag, name) != moab::MB_SUCCESS
+        || source.mb->tag_get_data_type(tag, data_type) != moab::MB_SUCCESS
+        || source.mb->tag_get_type(tag, tag_type) != moab::MB_SUCCESS
+        || source.mb->tag_get_length(tag, length) != moab::MB_SUCCESS
+        || source.mb->tag_get_bytes(tag, bytes) != moab::MB_SUCCESS
+       ) {
+      // e.g., variable-length tags
+      continue;
+    }
+    // Skip MOAB-internal tags (parallel status etc.) and tags whose values
+    // refer to entities of the source.
+    if (name.compare(0, 2, "__") == 0
+        || data_type == moab::MB_TYPE_HANDLE
+        || tag_type == moab::MB_TAG_BIT
+        || tag_type == moab::MB_TAG_MESH
+       ) {
+      continue;
+    }
+
+    moab::Tag new_tag;
+    if (target.mb->tag_get_handle(name.c_str(), length, data_type, new_tag)
+        != moab::MB_SUCCESS) {
+      std::vector<char> default_value(bytes);
+      const bool has_default =
+        source.mb->tag_get_default_value(tag, default_value.data())
+        == moab::MB_SUCCESS;
+      rval = target.mb->tag_get_handle(
+          name.c_str(),
+          length,
+          data_type,
+          new_tag,
+          tag_type | moab::MB_TAG_CREAT,
+          has_default ? default_value.data() : nullptr
+          );
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+    }
+    copied_tags.push_back(std::make_pair(tag, new_tag));
+
+    // Tags that don't have values on all vertices (cells) are skipped for
+    // those.
+    for (const auto & entities: {
+        std::make_pair(&old_verts, &new_verts),
+        std::make_pair(&old_cells, &new_cells)
+        }) {
+      if (entities.first->empty()) {
+        continue;
+      }
+      std::vector<char> data(bytes * entities.first->size());
+      if (source.mb->tag_get_data(
+            tag,
+            entities.first->data(),
+            entities.first->size(),
+            data.data()
+            ) == moab::MB_SUCCESS) {
+        rval = target.mb->tag_set_data(new_tag, *entities.second, data.data());
+        TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+      }
+    }
+  }
+
+  // Copy the partition, material, Dirichlet, and Neumann sets with their
+  // tags. Without the partition sets, a parallel write of the target
+  // couldn't be read in parallel again.
+  std::vector<int> new_cell_index(num_cells);
+  for (int c = 0; c < num_cells; c++) {
+    new_cell_index[cell_order[c]] = c;
+  }
+  // other set members (e.g., the faces of side sets), created on demand
+  std::map<moab::EntityHandle, moab::EntityHandle> new_sides;
+  const auto new_handle = [&](
+      const moab::EntityHandle h
+      ) -> moab::EntityHandle {
+    const moab::EntityType type = source.mb->type_from_handle(h);
+    if (type == moab::MBVERTEX) {
+      return vert_start + new_index[verts.index(h)];
+    }
+    if (type == cell_type) {
+      return cell_start + new_cell_index[cells.index(h)];
+    }
+    const moab::EntityHandle * old_conn = nullptr;
+    int n = 0;
+    rval = source.mb->get_connectivity(h, old_conn, n, true);
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+    std::vector<moab::EntityHandle> conn(n);
+    for (int i = 0; i < n; i++) {
+      conn[i] = vert_start + new_index[verts.index(old_conn[i])];
+    }
+    if (type == moab::MBEDGE) {
+      const int a = conn[0] - vert_start;
+      const int b = conn[1] - vert_start;
+      const auto e = std::make_pair(std::min(a, b), std::max(a, b));
+      const auto it = std::lower_bound(edges.begin(), edges.end(), e);
+      if (it != edges.end() && *it == e) {
+        return edge_start + (it - edges.begin());
+      }
+    }
+    const auto it = new_sides.find(h);
+    if (it != new_sides.end()) {
+      return it->second;
+    }
+    moab::EntityHandle side;
+    rval = target.mb->create_element(type, conn.data(), n, side);
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+    new_sides[h] = side;
+    return side;
+  };
+
+  for (const auto & set_tag_name: {
+      PARALLEL_PARTITION_TAG_NAME,
+      MATERIAL_SET_TAG_NAME,
+      DIRICHLET_SET_TAG_NAME,
+      NEUMANN_SET_TAG_NAME
+      }) {
+    moab::Tag set_tag;
+    if (source.mb->tag_get_handle(set_tag_name, set_tag) != moab::MB_SUCCESS) {
+      continue;
+    }
+    moab::Range sets;
+    rval = source.mb->get_entities_by_type_and_tag(
+        0, moab::MBENTITYSET, &set_tag, nullptr, 1, sets
+        );
+    TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+
+    for (const auto set: sets) {
+      unsigned int options;
+      rval = source.mb->get_meshset_options(set, options);
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+      moab::EntityHandle new_set;
+      rval = target.mb->create_meshset(options, new_set);
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+
+      // Nested sets aren't copied.
+      std::vector<moab::EntityHandle> members;
+      rval = source.mb->get_entities_by_handle(set, members);
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+      std::vector<moab::EntityHandle> new_members;
+      new_members.reserve(members.size());
+      for (const auto member: members) {
+        if (source.mb->type_from_handle(member) != moab::MBENTITYSET) {
+          new_members.push_back(new_handle(member));
+        }
+      }
+      rval = target.mb->add_entities(
+          new_set, new_members.data(), new_members.size()
+          );
+      TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+
+      for (const auto & tag: copied_tags) {
+        int bytes;
+        rval = source.mb->tag_get_bytes(tag.first, bytes);
+        TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+        std::vector<char> data(bytes);
+        if (source.mb->tag_get_data(tag.first, &set, 1, data.data())
+            == moab::MB_SUCCESS) {
+          rval = target.mb->tag_set_data(tag.second, &new_set, 1, data.data());
+          TEUCHOS_ASSERT_EQUALITY(rval, moab::MB_SUCCESS);
+        }
+      }
+    }
+  }
+
+  return;
+}
+// =============================================================================
+} // namespace nosh
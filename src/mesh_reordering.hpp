@@ -0,0 +1,44 @@
+#ifndef NOSH_MESHREORDERING_HPP
+#define NOSH_MESHREORDERING_HPP
+// =============================================================================
+// includes
+#include <string>
+#include <vector>
+
+#include "moab_wrap.hpp"
+
+namespace nosh
+{
+//! Reverse Cuthill-McKee ordering of a symmetric graph in CSR format. Returns
+//! the old index for every new index.
+std::vector<int>
+reverse_cuthill_mckee(
+    const std::vector<int> & row_ptrs,
+    const std::vector<int> & cols
+    );
+
+//! Ordering of points along the Morton (Z-order) space-filling curve. Returns
+//! the old index for every new index.
+std::vector<int>
+morton_order(
+    const std::vector<double> & x,
+    const std::vector<double> & y,
+    const std::vector<double> & z
+    );
+
+//! Copy the cells, vertices and their tags from source into the empty target
+//! such that the vertices are ordered according to vertex_ordering ("rcm" or
+//! "morton"). Cells are sorted by their first vertex, and all edges are
+//! created, sorted by their vertices. Of the entity sets, the partition,
+//! material, Dirichlet, and Neumann sets are copied with their tags and
+//! members (without nested sets).
+void
+reorder_mesh(
+    moab_wrap & source,
+    moab_wrap & target,
+    const std::string & vertex_ordering
+    );
+
+} // namespace nosh
+// =============================================================================
+#endif // NOSH_MESHREORDERING_HPP
@@ -1,5 +1,7 @@
 #include "mesh_tetra.hpp"
 
+#include <algorithm>
+#include <array>
 #include <memory>
 
 #include <Tpetra_Vector.hpp>
@@ -15,9 +17,10 @@ mesh_tetra::
 mesh_tetra(
     const std::shared_ptr<const Teuchos::Comm<int>> & _comm,
     const std::shared_ptr<moab::ParallelComm> & mcomm,
-    const std::shared_ptr<moab::Core> & mb
+    const std::shared_ptr<moab::Core> & mb,
+    const std::shared_ptr<const mesh_cache> & cache
     ) :
-  mesh(_comm, mcomm, mb),
+  mesh(_comm, mcomm, mb, cache),
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   compute_edge_data_time_(
       Teuchos::TimeMonitor::getNewTimer(
@@ -32,6 +35,8 @@ mesh_tetra(
   edge_data_(this->compute_edge_data_()),
   boundary_surface_areas_(this->compute_boundary_surface_areas_())
 {
+  // All cached data has been copied; release the mapping.
+  this->cache_.reset();
 }
 // =============================================================================
 mesh_tetra::
@@ -42,6 +47,10 @@ std::vector<mesh::edge_data>
 mesh_tetra::
 compute_edge_data_() const
 {
+  if (this->cache_) {
+    return this->cache_->get<mesh::edge_data>("edge_data");
+  }
+
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   Teuchos::TimeMonitor tm(*compute_edge_data_time_);
 #endif
@@ -53,116 +62,153 @@ compute_edge_data_() const
 
   std::vector<mesh::edge_data> _edge_data(num_edges);
 
-  // compute all coordinates
-  std::vector<Eigen::Vector3d> edge_coords(num_edges);
+  // compute all edge lengths
+  const auto & x = this->vertex_coords();
   for (size_t k = 0; k < num_edges; k++) {
-    auto tmp1 = std::get<0>(relations_.edge_vertices[k]);
-    const auto coords0 = this->mbw_->get_coords({tmp1});
-
-    tmp1 = std::get<1>(relations_.edge_vertices[k]);
-    const auto coords1 = this->mbw_->get_coords({tmp1});
+    const int i0 = this->edge_lids[k][0];
+    const int i1 = this->edge_lids[k][1];
 
-    edge_coords[k][0] = coords0[0] - coords1[0];
-    edge_coords[k][1] = coords0[1] - coords1[1];
-    edge_coords[k][2] = coords0[2] - coords1[2];
+    const Eigen::Vector3d edge_coords(
+        x.x[i0] - x.x[i1],
+        x.y[i0] - x.y[i1],
+        x.z[i0] - x.z[i1]
+        );
 
-    _edge_data[k].length = edge_coords[k].norm();
+    _edge_data[k].length = edge_coords.norm();
   }
 
-  // Compute the contributions edge by edge.
-  for (size_t k = 0; k < num_cells; k++) {
-    const std::vector<size_t> edge_idxs = {
-      this->local_index(relations_.cell_edges[k][0]),
-      this->local_index(relations_.cell_edges[k][1]),
-      this->local_index(relations_.cell_edges[k][2]),
-      this->local_index(relations_.cell_edges[k][3]),
-      this->local_index(relations_.cell_edges[k][4]),
-      this->local_index(relations_.cell_edges[k][5])
-    };
-
-    const std::vector<Eigen::Vector3d> local_edge_coords = {
-      edge_coords[edge_idxs[0]],
-      edge_coords[edge_idxs[1]],
-      edge_coords[edge_idxs[2]],
-      edge_coords[edge_idxs[3]],
-      edge_coords[edge_idxs[4]],
-      edge_coords[edge_idxs[5]]
-    };
-
-    auto edge_coeffs = edge_coefficients_cell_(local_edge_coords);
-
-    // Fill the edge coefficients into the vector.
-    for (int i = 0; i < edge_coeffs.size(); i++) {
-      const size_t edge_idx = this->local_index(relations_.cell_edges[k][i]);
-      _edge_data[edge_idx].covolume +=
-        edge_coeffs[i] * _edge_data[edge_idx].length;
-    }
+  const auto conn = this->get_connectivity_lids_(
+      std::vector<moab::EntityHandle>(cells.begin(), cells.end())
+      );
+#ifndef NDEBUG
+  TEUCHOS_ASSERT_EQUALITY(conn.size(), 4 * num_cells);
+#endif
+
+  // Compute the contributions cell by cell. The cells are processed in
+  // batches such that the coefficient kernel vectorizes.
+  const size_t num_batches = (num_cells + batch_size_ - 1) / batch_size_;
+  const auto covolumes = this->parallel_sum_(
+      num_batches,
+      num_edges,
+      [&](const size_t batch, double * covolume) {
+        const size_t k0 = batch * batch_size_;
+        const size_t n = std::min(num_cells - k0, size_t(batch_size_));
+
+        std::array<batch_array, 12> cell_coords;
+        for (int b = 0; b < batch_size_; b++) {
+          // Pad the last batch by repeating its last cell.
+          const size_t k = k0 + std::min(size_t(b), n - 1);
+          const int * vertex_idxs = &conn[4*k];
+          for (int i = 0; i < 4; i++) {
+            cell_coords[3*i][b] = x.x[vertex_idxs[i]];
+            cell_coords[3*i + 1][b] = x.y[vertex_idxs[i]];
+            cell_coords[3*i + 2][b] = x.z[vertex_idxs[i]];
+          }
+        }
+
+        std::array<batch_array, 6> coeffs;
+        this->edge_coefficients_batch_(cell_coords, coeffs);
+
+        for (size_t b = 0; b < n; b++) {
+          // The cell edges are stored in the kernel order (0,1), (0,2),
+          // (0,3), (1,2), (1,3), (2,3).
+          for (int i = 0; i < 6; i++) {
+            const int edge_idx = relations_.cell_edges[6*(k0 + b) + i];
+            covolume[edge_idx] += coeffs[i][b] * _edge_data[edge_idx].length;
+          }
+        }
+      });
+
+  // Fill the edge coefficients into the vector.
+  for (size_t k = 0; k < num_edges; k++) {
+    _edge_data[k].covolume = covolumes[k];
   }
 
   return _edge_data;
 }
 // =============================================================================
-Eigen::VectorXd
+void
 mesh_tetra::
-edge_coefficients_cell_(
-  const std::vector<Eigen::Vector3d> & edges
-  ) const
+edge_coefficients_batch_(
+    const std::array<batch_array, 12> & x,
+    std::array<batch_array, 6> & coeffs
+    ) const
 {
-  size_t num_edges = edges.size();
-
-  // Build an equation system for the edge coefficients alpha_k.
-  // They fulfill
+  // The edge coefficients alpha_ij fulfill
   //
-  //    |simplex| * <u,v> = \sum_{edges e_i} alpha_i <u,e_i> <e_i,v>
+  //    |simplex| * <u,v> = \sum_{edges e_ij} alpha_ij <u,e_ij> <e_ij,v>
   //
-  // for any pair of vectors u, v in the plane of the triangle.
+  // for any pair of vectors u, v. The solution of this 6x6 system is given by
+  // the gradients of the barycentric coordinates lambda_i,
   //
-  double vol;
-  // TODO(nschloe): Come up with a cleaner solution here.
-  try {
-    vol = get_tetrahedron_volume_(edges[0], edges[1], edges[2]);
-  } catch(...) {
-    // If computing the volume throws an exception, then the edges chosen
-    // happened to be conplanar. Changing one of those fixes this.
-    vol = get_tetrahedron_volume_(edges[0], edges[1], edges[3]);
-  }
-
-  Eigen::Matrix<double, 6, 6> A;
-  Eigen::VectorXd rhs(6);
-
-  // Build the equation system:
-  // The equation
+  //    alpha_ij = - |simplex| <grad(lambda_i), grad(lambda_j)>,
   //
-  //    |simplex| ||u||^2 = \sum_i \alpha_i <u,e_i> <e_i,u>
+  // (the off-diagonal entries of the P1 stiffness matrix). With d_i = x_i -
+  // x_0 and D = <d_1, d_2 x d_3>, the gradients are
   //
-  // has to hold for all vectors u in the plane spanned by the edges,
-  // particularly by the edges themselves.
+  //    grad(lambda_1) = d_2 x d_3 / D,
+  //    grad(lambda_2) = d_3 x d_1 / D,
+  //    grad(lambda_3) = d_1 x d_2 / D,
+  //    grad(lambda_0) = - grad(lambda_1) - grad(lambda_2) - grad(lambda_3).
   //
-  // Only fill the upper part of the Hermitian matrix.
-  //
-  for (size_t i = 0; i < num_edges; i++) {
-    double alpha = edges[i].dot(edges[i]);
-    rhs(i) = vol * alpha;
-    A(i, i) = alpha * alpha;
-    for (size_t j = i+1; j < num_edges; j++) {
-      A(i, j) = edges[i].dot(edges[j]) * edges[j].dot(edges[i]);
-      A(j, i) = A(i, j);
-    }
-  }
+  const batch_array d1x = x[3] - x[0];
+  const batch_array d1y = x[4] - x[1];
+  const batch_array d1z = x[5] - x[2];
+  const batch_array d2x = x[6] - x[0];
+  const batch_array d2y = x[7] - x[1];
+  const batch_array d2z = x[8] - x[2];
+  const batch_array d3x = x[9] - x[0];
+  const batch_array d3y = x[10] - x[1];
+  const batch_array d3z = x[11] - x[2];
+
+  // c_i = D * grad(lambda_i)
+  const batch_array c1x = d2y*d3z - d2z*d3y;
+  const batch_array c1y = d2z*d3x - d2x*d3z;
+  const batch_array c1z = d2x*d3y - d2y*d3x;
+  const batch_array c2x = d3y*d1z - d3z*d1y;
+  const batch_array c2y = d3z*d1x - d3x*d1z;
+  const batch_array c2z = d3x*d1y - d3y*d1x;
+  const batch_array c3x = d1y*d2z - d1z*d2y;
+  const batch_array c3y = d1z*d2x - d1x*d2z;
+  const batch_array c3z = d1x*d2y - d1y*d2x;
+  const batch_array c0x = -c1x - c2x - c3x;
+  const batch_array c0y = -c1y - c2y - c3y;
+  const batch_array c0z = -c1z - c2z - c3z;
+
+  const batch_array abs_det = (d1x*c1x + d1y*c1y + d1z*c1z).abs();
+
+  // Make sure the tetrahedra are not flat.
+  const batch_array norms = (
+      (d1x*d1x + d1y*d1y + d1z*d1z)
+      * (d2x*d2x + d2y*d2y + d2z*d2z)
+      * (d3x*d3x + d3y*d3y + d3z*d3z)
+      ).sqrt();
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      (abs_det < 1.0e-5 * norms).any(),
+      "Illegal mesh: tetrahedron too flat."
+      );
+
+  // |simplex| = |D| / 6
+  const batch_array s = -1.0 / (6.0 * abs_det);
 
-  // Solve the equation system for the alpha_i.  The system is symmetric and,
-  // if the simplex is not degenerate, positive definite.
-  const auto x = A.fullPivLu().solve(rhs);
-  //const auto x = A.colPivHouseholderQr().solve(rhs);
-  //const auto x = A.ldlt().solve(rhs);
+  coeffs[0] = (c0x*c1x + c0y*c1y + c0z*c1z) * s;
+  coeffs[1] = (c0x*c2x + c0y*c2y + c0z*c2z) * s;
+  coeffs[2] = (c0x*c3x + c0y*c3y + c0z*c3z) * s;
+  coeffs[3] = (c1x*c2x + c1y*c2y + c1z*c2z) * s;
+  coeffs[4] = (c1x*c3x + c1y*c3y + c1z*c3z) * s;
+  coeffs[5] = (c2x*c3x + c2y*c3y + c2z*c3z) * s;
 
-  return x;
+  return;
 }
 // =============================================================================
 std::shared_ptr<Tpetra::Vector<double,int,int>>
 mesh_tetra::
 compute_control_volumes_() const
 {
+  if (this->cache_) {
+    return this->get_cached_control_volumes_();
+  }
+
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   Teuchos::TimeMonitor tm(*compute_control_volumes_time_);
 #endif
@@ -182,11 +228,7 @@ compute_control_volumes_() const
   this->compute_control_volumes_t_(cv_overlap);
 
   // Export control volumes to a non-overlapping map, and sum the entries.
-  Teuchos::RCP<const Tpetra::Export<int,int>> exporter = Tpetra::createExport(
-      Teuchos::rcp(vertices_overlap_map_),
-      Teuchos::rcp(vertices_map_)
-      );
-  _control_volumes->doExport(cv_overlap, *exporter, Tpetra::ADD);
+  _control_volumes->doExport(cv_overlap, *this->exporter(), Tpetra::ADD);
 
   return _control_volumes;
 }
@@ -196,77 +238,80 @@ mesh_tetra::
 compute_control_volumes_t_(Tpetra::Vector<double,int,int> & cv_overlap) const
 {
   // get owned entities
-  moab::Range cells = this->mbw_->get_entities_by_dimension(0, 3);
+  const moab::Range cells = this->mbw_->get_entities_by_dimension(0, 3);
 
   const size_t num_cells = cells.size();
 
-  Teuchos::ArrayRCP<double> cv_data = cv_overlap.getDataNonConst();
-
-  // Calculate the contributions to the finite volumes cell by cell.
-  for (size_t k = 0; k < num_cells; k++) {
-    const auto conn = this->mbw_->get_connectivity(cells[k]);
-
+  const auto conn = this->get_connectivity_lids_(
+      std::vector<moab::EntityHandle>(cells.begin(), cells.end())
+      );
 #ifndef NDEBUG
-    TEUCHOS_ASSERT_EQUALITY(conn.size(), 4);
+  TEUCHOS_ASSERT_EQUALITY(conn.size(), 4 * num_cells);
 #endif
 
-    // Fetch the nodal positions into 'local_node_coords'.
-    const auto coords = this->mbw_->get_coords(conn);
-
-    std::vector<Eigen::Vector3d> local_node_coords(conn.size());
-    for (size_t i = 0; i < conn.size(); i++) {
-      // TODO(nschloe): do something smarter than copying here
-      local_node_coords[i][0] = coords[3*i];
-      local_node_coords[i][1] = coords[3*i + 1];
-      local_node_coords[i][2] = coords[3*i + 2];
-    }
-
-    // compute the circumcenter of the cell
-    const auto cc = this->compute_tetrahedron_circumcenter_(local_node_coords);
-
-    // Iterate over the edges.
-    // As true edge entities are not available here, loop over all pairs of
-    // local vertices.
-    for (size_t e0 = 0; e0 < conn.size(); e0++) {
-      const Eigen::Vector3d &x0 = local_node_coords[e0];
-      for (size_t e1 = e0+1; e1 < conn.size(); e1++) {
-        const Eigen::Vector3d &x1 = local_node_coords[e1];
-
-        // Get the other vertices.
-        std::set<unsigned int> other_set = this->get_other_indices_(e0, e1);
-        // Convert to vector (easier to handle for now)
-        std::vector<unsigned int> other(other_set.begin(), other_set.end() );
-
-        double edge_length = (x1 - x0).norm();
-
-        // Compute the (n-1)-dimensional covolume.
-        const Eigen::Vector3d &other0 = local_node_coords[other[0]];
-        const Eigen::Vector3d &other1 = local_node_coords[other[1]];
-        double covolume = this->compute_covolume3d_(cc, x0, x1, other0, other1);
-        // Throw an exception for 3D volumes.
-        // To compute the average of the thicknesses of a control volume, one
-        // has to loop over all the edges and add the thickness value to both
-        // endpoints.  Then eventually, for each node, divide the resulting sum
-        // by the number of connections (=number of faces of the finite
-        // volume).  However, looping over edges is not (yet) possible. Hence,
-        // we loop over all the cells here. This way, the edges are counted
-        // several times, but it is difficult to determine how many times
-        // exactly.
-        //TEUCHOS_TEST_FOR_EXCEPTION(
-        //    true,
-        //    std::runtime_error,
-        //    "Cannot calculate the average thickness in a 3D control volume yet."
-        //    );
-
-        // Compute the contributions to the finite volumes of the adjacent
-        // edges.
-        double pyramid_volume = 0.5 * edge_length * covolume / 3;
-        // The EntityHandle (conn) is a local identifier, MOAB indices are
-        // 1-based.
-        cv_data[conn[e0] - 1] += pyramid_volume;
-        cv_data[conn[e1] - 1] += pyramid_volume;
-      }
-    }
+  const auto & x = this->vertex_coords();
+
+  Teuchos::ArrayRCP<double> cv_data = cv_overlap.getDataNonConst();
+
+  // Calculate the contributions to the finite volumes cell by cell.
+  const auto cv = this->parallel_sum_(
+      num_cells,
+      cv_data.size(),
+      [&](const size_t k, double * partial) {
+        // Fetch the nodal positions into 'local_node_coords'.
+        std::vector<Eigen::Vector3d> local_node_coords(4);
+        for (size_t i = 0; i < 4; i++) {
+          const int lid = conn[4*k + i];
+          local_node_coords[i] = Eigen::Vector3d(x.x[lid], x.y[lid], x.z[lid]);
+        }
+
+        // compute the circumcenter of the cell
+        const auto cc = this->compute_tetrahedron_circumcenter_(local_node_coords);
+
+        // Iterate over the edges.
+        // As true edge entities are not available here, loop over all pairs of
+        // local vertices.
+        for (size_t e0 = 0; e0 < 4; e0++) {
+          const Eigen::Vector3d &x0 = local_node_coords[e0];
+          for (size_t e1 = e0+1; e1 < 4; e1++) {
+            const Eigen::Vector3d &x1 = local_node_coords[e1];
+            // Get the other vertices.
+            std::set<unsigned int> other_set = this->get_other_indices_(e0, e1);
+            // Convert to vector (easier to handle for now)
+            std::vector<unsigned int> other(other_set.begin(), other_set.end() );
+
+            double edge_length = (x1 - x0).norm();
+
+            // Compute the (n-1)-dimensional covolume.
+            const Eigen::Vector3d &other0 = local_node_coords[other[0]];
+            const Eigen::Vector3d &other1 = local_node_coords[other[1]];
+            double covolume = this->compute_covolume3d_(cc, x0, x1, other0, other1);
+            // Throw an exception for 3D volumes.
+            // To compute the average of the thicknesses of a control volume, one
+            // has to loop over all the edges and add the thickness value to both
+            // endpoints.  Then eventually, for each node, divide the resulting sum
+            // by the number of connections (=number of faces of the finite
+            // volume).  However, looping over edges is not (yet) possible. Hence,
+            // we loop over all the cells here. This way, the edges are counted
+            // several times, but it is difficult to determine how many times
+            // exactly.
+            //TEUCHOS_TEST_FOR_EXCEPTION(
+            //    true,
+            //    std::runtime_error,
+            //    "Cannot calculate the average thickness in a 3D control volume yet."
+            //    );
+
+            // Compute the contributions to the finite volumes of the adjacent
+            // edges.
+            double pyramid_volume = 0.5 * edge_length * covolume / 3;
+            partial[conn[4*k + e0]] += pyramid_volume;
+            partial[conn[4*k + e1]] += pyramid_volume;
+          }
+        }
+      });
+
+  for (size_t k = 0; k < cv.size(); k++) {
+    cv_data[k] += cv[k];
   }
 }
 // =============================================================================
@@ -348,30 +393,6 @@ get_other_indices_(unsigned int e0, unsigned int e1) const
   return a;
 }
 // =============================================================================
-double
-mesh_tetra::
-get_tetrahedron_volume_(
-    const Eigen::Vector3d &edge0,
-    const Eigen::Vector3d &edge1,
-    const Eigen::Vector3d &edge2
-    ) const
-{
-  // Make sure the edges are not conplanar.
-  double alpha = edge0.dot(edge1.cross(edge2));
-  TEUCHOS_TEST_FOR_EXCEPT_MSG(
-      fabs(alpha) / edge0.norm() / edge1.norm() / edge2.norm() < 1.0e-5,
-      "Illegal mesh: tetrahedron too flat.\n"
-      << "The following edges (with origin (0,0,0)) "
-      << "seem to be conplanar:\n\n"
-      << "  (0) " << edge0 << ",\n"
-      << "  (1) " << edge1 << ",\n"
-      << "  (2) " << edge2 << ",\n\n"
-      << "Abort."
-      );
-  double vol = fabs(alpha) / 6.0;
-  return vol;
-}
-// =============================================================================
 Eigen::Vector3d
 mesh_tetra::
 compute_tetrahedron_circumcenter_(
@@ -440,24 +461,29 @@ std::vector<double>
 mesh_tetra::
 compute_boundary_surface_areas_() const
 {
+  if (this->cache_) {
+    return this->cache_->get<double>("boundary_surface_areas");
+  }
+
   // Store data for _all_ vertices. We actually only set the boundary ones
   // though.
   // This could be organized more efficiently with MOAB tags.
-  const moab::Range vertices = this->mbw_->get_entities_by_dimension(0, 0);
-  const size_t num_vertices = vertices.size();
-  std::vector<double> boundary_surface_areas(num_vertices);
-  std::fill(boundary_surface_areas.begin(), boundary_surface_areas.end(), 0.0);
-
-  for (unsigned long k : this->boundary_skin_) {
-    const auto verts = this->mbw_->get_connectivity(k);
-    const auto splitting = this->compute_triangle_splitting_(verts);
-    // add contributions to the verts
-    boundary_surface_areas[this->local_index(verts[0])] += splitting[0];
-    boundary_surface_areas[this->local_index(verts[1])] += splitting[1];
-    boundary_surface_areas[this->local_index(verts[2])] += splitting[2];
-  }
-
-  return boundary_surface_areas;
+  const size_t num_vertices = this->vertex_coords().x.size();
+
+  const auto verts = this->get_connectivity_lids_(this->boundary_skin_);
+
+  return this->parallel_sum_(
+      this->boundary_skin_.size(),
+      num_vertices,
+      [&](const size_t k, double * boundary_surface_areas) {
+        const auto splitting = this->compute_triangle_splitting_(
+            verts[3*k], verts[3*k + 1], verts[3*k + 2]
+            );
+        // add contributions to the verts
+        boundary_surface_areas[verts[3*k]] += splitting[0];
+        boundary_surface_areas[verts[3*k + 1]] += splitting[1];
+        boundary_surface_areas[verts[3*k + 2]] += splitting[2];
+      });
 }
 // =============================================================================
 }  // namespace nosh
@@ -2,6 +2,7 @@
 #define NOSH_MESHTETRA_HPP
 // =============================================================================
 //// includes
+#include <array>
 #include <vector>
 #include <set>
 
@@ -28,7 +29,8 @@ public:
   mesh_tetra(
       const std::shared_ptr<const Teuchos::Comm<int>> & _comm,
       const std::shared_ptr<moab::ParallelComm> & mcomm,
-      const std::shared_ptr<moab::Core> & mb
+      const std::shared_ptr<moab::Core> & mb,
+      const std::shared_ptr<const mesh_cache> & cache = nullptr
       );
 
   ~mesh_tetra() override;
@@ -86,9 +88,14 @@ private:
     const std::vector<Eigen::Vector3d> & vertices
     ) const;
 
-  Eigen::VectorXd
-  edge_coefficients_cell_(
-    const std::vector<Eigen::Vector3d> & edges
+  //! Edge coefficients for a batch of cells, given the coordinates of the
+  //! four vertices of each cell (x[3*i + d] is the d-th coordinate of the i-th
+  //! vertex). The coefficients come in the order of the local edges (0, 1),
+  //! (0, 2), (0, 3), (1, 2), (1, 3), (2, 3).
+  void
+  edge_coefficients_batch_(
+    const std::array<batch_array, 12> & x,
+    std::array<batch_array, 6> & coeffs
     ) const;
 
   //! Compute the volume of the (Voronoi) control cells for each point.
@@ -98,13 +105,6 @@ private:
   void
   compute_control_volumes_t_(Tpetra::Vector<double,int,int> & cv_overlap) const;
 
-  double
-  get_tetrahedron_volume_(
-      const Eigen::Vector3d &edge0,
-      const Eigen::Vector3d &edge1,
-      const Eigen::Vector3d &edge2
-      ) const;
-
   Eigen::Vector3d
   compute_tetrahedron_circumcenter_(
       const std::vector<Eigen::Vector3d> &vertices
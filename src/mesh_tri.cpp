@@ -1,5 +1,7 @@
 #include "mesh_tri.hpp"
 
+#include <algorithm>
+#include <array>
 #include <set>
 #include <vector>
 
@@ -15,9 +17,10 @@ mesh_tri::
 mesh_tri(
     const std::shared_ptr<const Teuchos::Comm<int>> & _comm,
     const std::shared_ptr<moab::ParallelComm> & mcomm,
-    const std::shared_ptr<moab::Core> & mb
+    const std::shared_ptr<moab::Core> & mb,
+    const std::shared_ptr<const mesh_cache> & cache
     ) :
-  mesh(_comm, mcomm, mb)
+  mesh(_comm, mcomm, mb, cache)
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   ,compute_edge_data_time_(
       Teuchos::TimeMonitor::getNewTimer(
@@ -36,6 +39,8 @@ mesh_tri(
   ,edge_data_(this->compute_edge_data_())
   ,boundary_surface_areas_(this->compute_boundary_surface_areas_())
 {
+  // All cached data has been copied; release the mapping.
+  this->cache_.reset();
 }
 // =============================================================================
 mesh_tri::
@@ -45,6 +50,10 @@ std::vector<mesh::edge_data>
 mesh_tri::
 compute_edge_data_() const
 {
+  if (this->cache_) {
+    return this->cache_->get<mesh::edge_data>("edge_data");
+  }
+
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   // timer for this routine
   Teuchos::TimeMonitor tm(*compute_edge_data_time_);
@@ -59,101 +68,103 @@ compute_edge_data_() const
   std::vector<edge_data> _edge_data(num_edges);
 
   // compute all coordinates
+  const auto & x = this->vertex_coords();
   std::vector<Eigen::Vector3d> edge_coords(num_edges);
   for (size_t k = 0; k < num_edges; k++) {
-    auto tmp1 = std::get<0>(relations_.edge_vertices[k]);
-    std::vector<double> coords0 = this->mbw_->get_coords({tmp1});
+    const int i0 = this->edge_lids[k][0];
+    const int i1 = this->edge_lids[k][1];
 
-    tmp1 = std::get<1>(relations_.edge_vertices[k]);
-    std::vector<double> coords1 = this->mbw_->get_coords({tmp1});
-
-    edge_coords[k][0] = coords0[0] - coords1[0];
-    edge_coords[k][1] = coords0[1] - coords1[1];
-    edge_coords[k][2] = coords0[2] - coords1[2];
+    edge_coords[k][0] = x.x[i0] - x.x[i1];
+    edge_coords[k][1] = x.y[i0] - x.y[i1];
+    edge_coords[k][2] = x.z[i0] - x.z[i1];
 
     _edge_data[k].length = edge_coords[k].norm();
   }
 
-  // Compute the contributions cell by cell.
-  for (size_t k = 0; k < num_cells; k++) {
-    const std::vector<size_t> edge_idxs = {
-      this->local_index(relations_.cell_edges[k][0]),
-      this->local_index(relations_.cell_edges[k][1]),
-      this->local_index(relations_.cell_edges[k][2])
-    };
-    const std::vector<Eigen::Vector3d> local_edge_coords = {
-      edge_coords[edge_idxs[0]],
-      edge_coords[edge_idxs[1]],
-      edge_coords[edge_idxs[2]]
-    };
-
-    Eigen::VectorXd edge_coeffs =
-      edge_coefficients_numerically_(local_edge_coords);
-
-    // Fill the edge coefficients into the vector.
-    for (int i = 0; i < edge_coeffs.size(); i++) {
-      const size_t edge_idx = this->local_index(relations_.cell_edges[k][i]);
-      // const int edge_id = this->liddd
-      _edge_data[edge_idx].covolume +=
-        edge_coeffs[i] * _edge_data[edge_idx].length;
-    }
+  // Compute the contributions cell by cell. The cells are processed in
+  // batches such that the coefficient kernel vectorizes.
+  const size_t num_batches = (num_cells + batch_size_ - 1) / batch_size_;
+  const auto covolumes = this->parallel_sum_(
+      num_batches,
+      num_edges,
+      [&](const size_t batch, double * covolume) {
+        const size_t k0 = batch * batch_size_;
+        const size_t n = std::min(num_cells - k0, size_t(batch_size_));
+
+        std::array<batch_array, 9> e;
+        for (int b = 0; b < batch_size_; b++) {
+          // Pad the last batch by repeating its last cell.
+          const size_t k = k0 + std::min(size_t(b), n - 1);
+          for (int i = 0; i < 3; i++) {
+            const int edge_idx = relations_.cell_edges[3*k + i];
+            e[3*i][b] = edge_coords[edge_idx][0];
+            e[3*i + 1][b] = edge_coords[edge_idx][1];
+            e[3*i + 2][b] = edge_coords[edge_idx][2];
+          }
+        }
+
+        std::array<batch_array, 3> coeffs;
+        this->edge_coefficients_batch_(e, coeffs);
+
+        for (size_t b = 0; b < n; b++) {
+          for (int i = 0; i < 3; i++) {
+            const int edge_idx = relations_.cell_edges[3*(k0 + b) + i];
+            covolume[edge_idx] += coeffs[i][b] * _edge_data[edge_idx].length;
+          }
+        }
+      });
+
+  // Fill the edge coefficients into the vector.
+  for (size_t k = 0; k < num_edges; k++) {
+    _edge_data[k].covolume = covolumes[k];
   }
 
   return _edge_data;
 }
 // =============================================================================
-Eigen::VectorXd
+void
 mesh_tri::
-edge_coefficients_numerically_(
-  const std::vector<Eigen::Vector3d> & edges
-  ) const
+edge_coefficients_batch_(
+    const std::array<batch_array, 9> & e,
+    std::array<batch_array, 3> & coeffs
+    ) const
 {
-  size_t num_edges = edges.size();
-  TEUCHOS_ASSERT_EQUALITY(num_edges, 3);
-
-  // Build an equation system for the edge coefficients alpha_k.
-  // They fulfill
+  // The edge coefficients alpha_i fulfill
   //
   //    |simplex| * <u,v> = \sum_{edges e_i} alpha_i <u,e_i> <e_i,v>
   //
-  // for any pair of vectors u, v in the plane of the triangle.
-  //
-  const double vol = 0.5 * (edges[0].cross(edges[1])).norm();
-
-  Eigen::Matrix3d A;
-  Eigen::Vector3d rhs;
-
-  // Build the equation system:
-  // The equation
+  // for any pair of vectors u, v in the plane of the triangle. The solution
+  // of this 3x3 system is alpha_i = 0.5 * cot(theta_i), theta_i being the
+  // angle opposite of e_i. With the law of cosines, this is
   //
-  //    |simplex| ||u||^2 = \sum_i \alpha_i <u,e_i> <e_i,u>
+  //    alpha_i = (|e_j|^2 + |e_k|^2 - |e_i|^2) / (8 |simplex|),
   //
-  // has to hold for all vectors u in the plane spanned by the edges,
-  // particularly by the edges themselves.
-  //
-  for (size_t i = 0; i < num_edges; i++) {
-    double alpha = edges[i].dot(edges[i]);
-    rhs(i) = vol * alpha;
-    A(i, i) = alpha * alpha;
-    for (size_t j = i+1; j < num_edges; j++) {
-      A(i, j) = edges[i].dot(edges[j]) * edges[j].dot(edges[i]);
-      A(j, i) = A(i, j);
-    }
-  }
+  // independent of the orientation of the edges.
+  const batch_array l0 = e[0]*e[0] + e[1]*e[1] + e[2]*e[2];
+  const batch_array l1 = e[3]*e[3] + e[4]*e[4] + e[5]*e[5];
+  const batch_array l2 = e[6]*e[6] + e[7]*e[7] + e[8]*e[8];
 
-  // Solve the equation system for the alpha_i.  The system is symmetric and,
-  // if the simplex is not degenerate, positive definite.
-  //return A.ldlt().solve(rhs);
-  const auto x = A.fullPivLu().solve(rhs);
-  //auto x = A.colPivHouseholderQr().solve(rhs);
+  // twice the area: |e_0 x e_1|
+  const batch_array nx = e[1]*e[5] - e[2]*e[4];
+  const batch_array ny = e[2]*e[3] - e[0]*e[5];
+  const batch_array nz = e[0]*e[4] - e[1]*e[3];
+  const batch_array s = 0.25 / (nx*nx + ny*ny + nz*nz).sqrt();
 
-  return x;
+  coeffs[0] = (l1 + l2 - l0) * s;
+  coeffs[1] = (l2 + l0 - l1) * s;
+  coeffs[2] = (l0 + l1 - l2) * s;
+
+  return;
 }
 // =============================================================================
 std::shared_ptr<Tpetra::Vector<double,int,int>>
 mesh_tri::
 compute_control_volumes_() const
 {
+  if (this->cache_) {
+    return this->get_cached_control_volumes_();
+  }
+
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   Teuchos::TimeMonitor tm(*compute_control_volumes_time_);
 #endif
@@ -172,12 +183,7 @@ compute_control_volumes_() const
   this->compute_control_volumes_t_(cv_overlap);
 
   // Export control volumes to a non-overlapping map, and sum the entries.
-  Teuchos::RCP<const Tpetra::Export<int,int>> exporter = Tpetra::createExport(
-      Teuchos::rcp(vertices_overlap_map_),
-      Teuchos::rcp(vertices_map_)
-      );
-
-  _control_volumes->doExport(cv_overlap, *exporter, Tpetra::ADD);
+  _control_volumes->doExport(cv_overlap, *this->exporter(), Tpetra::ADD);
 
   return _control_volumes;
 }
@@ -187,23 +193,29 @@ mesh_tri::
 compute_control_volumes_t_(Tpetra::Vector<double,int,int> & cv_overlap) const
 {
   // get owned entities
-  moab::Range cells = this->mbw_->get_entities_by_dimension(0, 2);
+  const moab::Range cells = this->mbw_->get_entities_by_dimension(0, 2);
 
-  Teuchos::ArrayRCP<double> cv_data = cv_overlap.getDataNonConst();
-  //const vector_fieldType & coords_field = get_node_field("coordinates");
+  const auto conn = this->get_connectivity_lids_(
+      std::vector<moab::EntityHandle>(cells.begin(), cells.end())
+      );
 
-  // std::vector<double> coords;
-  // ierr = mcomm_->getMoab()->get_vertex_coordinates(coords);
-  // TEUCHOS_ASSERT_EQUALITY(ierr, moab::MB_SUCCESS);
+  Teuchos::ArrayRCP<double> cv_data = cv_overlap.getDataNonConst();
 
   // Calculate the contributions to the finite volumes cell by cell.
-  for (unsigned long cell : cells) {
-    const auto conn = this->mbw_->get_connectivity(cell);
-    const auto splitting = this->compute_triangle_splitting_(conn);
-
-    for (int i = 0; i < 3; i++) {
-      cv_data[this->local_index(conn[i])] += splitting[i];
-    }
+  const auto cv = this->parallel_sum_(
+      cells.size(),
+      cv_data.size(),
+      [&](const size_t k, double * partial) {
+        const auto splitting = this->compute_triangle_splitting_(
+            conn[3*k], conn[3*k + 1], conn[3*k + 2]
+            );
+        for (int i = 0; i < 3; i++) {
+          partial[conn[3*k + i]] += splitting[i];
+        }
+      });
+
+  for (size_t k = 0; k < cv.size(); k++) {
+    cv_data[k] += cv[k];
   }
 
   return;
@@ -213,26 +225,28 @@ std::vector<double>
 mesh_tri::
 compute_boundary_surface_areas_() const
 {
+  if (this->cache_) {
+    return this->cache_->get<double>("boundary_surface_areas");
+  }
+
   // Store data for _all_ vertices. We actually only set the boundary ones
   // though.
   // This could be organized more efficiently with MOAB tags.
-  const moab::Range vertices = this->mbw_->get_entities_by_dimension(0, 0);
-  const size_t num_vertices = vertices.size();
-  std::vector<double> boundary_surface_areas(num_vertices);
-  // initialize to 0
-  std::fill(boundary_surface_areas.begin(), boundary_surface_areas.end(), 0.0);
-
-  for (size_t k = 0; k < this->boundary_skin_.size(); k++) {
-    const size_t edge_idx = this->local_index(boundary_skin_[k]);
-    const auto verts = this->mbw_->get_connectivity(boundary_skin_[k]);
-    // add contributions to the verts
-    boundary_surface_areas[this->local_index(verts[0])] +=
-      0.5 * this->edge_data_[edge_idx].length;
-    boundary_surface_areas[this->local_index(verts[1])] +=
-      0.5 * this->edge_data_[edge_idx].length;
-  }
-
-  return boundary_surface_areas;
+  const size_t num_vertices = this->vertex_coords().x.size();
+
+  const auto verts = this->get_connectivity_lids_(this->boundary_skin_);
+
+  return this->parallel_sum_(
+      this->boundary_skin_.size(),
+      num_vertices,
+      [&](const size_t k, double * boundary_surface_areas) {
+        const size_t edge_idx = this->local_index(this->boundary_skin_[k]);
+        // add contributions to the verts
+        boundary_surface_areas[verts[2*k]] +=
+          0.5 * this->edge_data_[edge_idx].length;
+        boundary_surface_areas[verts[2*k + 1]] +=
+          0.5 * this->edge_data_[edge_idx].length;
+      });
 }
 // =============================================================================
 }  // namespace nosh
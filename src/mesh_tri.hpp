@@ -5,6 +5,8 @@
 
 #include "mesh.hpp"
 
+#include <array>
+
 #include <moab/Core.hpp>
 
 namespace nosh
@@ -18,7 +20,8 @@ public:
   mesh_tri(
       const std::shared_ptr<const Teuchos::Comm<int>> & _comm,
       const std::shared_ptr<moab::ParallelComm> & mcomm,
-      const std::shared_ptr<moab::Core> & mb
+      const std::shared_ptr<moab::Core> & mb,
+      const std::shared_ptr<const mesh_cache> & cache = nullptr
       );
 
   ~mesh_tri() override;
@@ -78,9 +81,13 @@ private:
       const Eigen::Vector3d &node2
       ) const;
 
-  Eigen::VectorXd
-  edge_coefficients_numerically_(
-    const std::vector<Eigen::Vector3d> & edges
+  //! Edge coefficients for a batch of cells, given the coordinates of the
+  //! three edge vectors of each cell (e[3*i + d] is the d-th component of the
+  //! i-th edge).
+  void
+  edge_coefficients_batch_(
+    const std::array<batch_array, 9> & e,
+    std::array<batch_array, 3> & coeffs
     ) const;
 
 private:
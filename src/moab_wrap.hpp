@@ -29,6 +29,7 @@
 #ifndef MOAB_WRAP_HPP
 #define MOAB_WRAP_HPP
 
+#include <array>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -173,6 +174,29 @@ namespace nosh {
         return coords;
       }
 
+      std::array<std::vector<double>, 3>
+      get_coords(const moab::Range & entities)
+      {
+        std::array<std::vector<double>, 3> coords = {{
+          std::vector<double>(entities.size()),
+          std::vector<double>(entities.size()),
+          std::vector<double>(entities.size())
+        }};
+        const auto rval = this->mb->get_coords(
+            entities,
+            coords[0].data(),
+            coords[1].data(),
+            coords[2].data()
+            );
+        if (rval != moab::MB_SUCCESS) {
+          std::ostringstream oss;
+          oss << "error in moab::get_coords "
+              << "(error code " << rval << ", " << translate_error_code_(rval) << ")";
+          throw std::runtime_error(oss.str());
+        }
+        return coords;
+      }
+
       moab::Range
       get_entities_by_type(
           const moab::EntityHandle meshset,
@@ -346,6 +370,72 @@ namespace nosh {
         return conn_vec;
       }
 
+      std::vector<moab::EntityHandle>
+      get_connectivity(
+          const std::vector<moab::EntityHandle> & entity_handles,
+          bool corners_only = false
+          )
+      {
+        std::vector<moab::EntityHandle> conn;
+        const auto rval = this->mb->get_connectivity(
+            entity_handles.data(),
+            entity_handles.size(),
+            conn,
+            corners_only
+            );
+        if (rval != moab::MB_SUCCESS) {
+          std::ostringstream oss;
+          oss << "error in moab::get_connectivity "
+              << "(error code " << rval << ", " << translate_error_code_(rval) << ")";
+          throw std::runtime_error(oss.str());
+        }
+        return conn;
+      }
+
+      // Connectivity of all entities, flat with stride verts_per_entity, read
+      // sequence by sequence directly from MOAB's connectivity arrays.
+      std::vector<moab::EntityHandle>
+      connect_iterate(
+          const moab::Range & entities,
+          int & verts_per_entity
+          )
+      {
+        std::vector<moab::EntityHandle> conn;
+        verts_per_entity = 0;
+        auto it = entities.begin();
+        while (it != entities.end()) {
+          moab::EntityHandle * seq_conn = nullptr;
+          int vpe = 0;
+          int count = 0;
+          const auto rval = this->mb->connect_iterate(
+              it,
+              entities.end(),
+              seq_conn,
+              vpe,
+              count
+              );
+          if (rval != moab::MB_SUCCESS) {
+            std::ostringstream oss;
+            oss << "error in moab::connect_iterate "
+                << "(error code " << rval << ", " << translate_error_code_(rval) << ")";
+            throw std::runtime_error(oss.str());
+          }
+          if (conn.empty()) {
+            verts_per_entity = vpe;
+            conn.reserve(vpe * entities.size());
+          }
+          if (vpe != verts_per_entity) {
+            throw std::runtime_error(
+                "error in moab::connect_iterate "
+                "(entities with different numbers of vertices)"
+                );
+          }
+          conn.insert(conn.end(), seq_conn, seq_conn + vpe * count);
+          it += count;
+        }
+        return conn;
+      }
+
     void
     load_file(
         const std::string & file_name,
@@ -24,9 +24,13 @@
 #include "parameter_matrix_base.hpp"
 #include "parameter_matrix_keo.hpp"
 #include "parameter_matrix_dkeo_dp.hpp"
+#include "parameter_matrix_keo_block.hpp"
+#include "parameter_matrix_keo_matrix_free.hpp"
+#include "parameter_matrix_dkeo_dp_block.hpp"
 #include "jacobian_operator.hpp"
 #include "keo_regularized.hpp"
 #include "mesh.hpp"
+#include "vector_pool.hpp"
 #include "Nosh_RealScalarProd.hpp"
 
 #include <string>
@@ -61,20 +65,54 @@ nls(
     const double g,
     const std::shared_ptr<const nosh::scalar_field::base> &thickness,
     const std::shared_ptr<const Tpetra::Vector<double,int,int>> &initial_x,
-    const std::string & deriv_parameter
+    const std::string & deriv_parameter,
+    const bool block_keo,
+    const bool matrix_free_keo
    ) :
   mesh_(_mesh),
   mvp_(mvp),
   scalar_potential_(scalar_potential),
   thickness_(thickness),
   keo_(
+      matrix_free_keo ?
+      std::shared_ptr<nosh::parameter_object>(
+        std::make_shared<nosh::parameter_matrix::keo_matrix_free>(
+          mesh_, thickness_, mvp_
+          )
+        ) :
+      block_keo ?
+      std::shared_ptr<nosh::parameter_object>(
+        std::make_shared<nosh::parameter_matrix::keo_block>(
+          mesh_, thickness_, mvp_
+          )
+        ) :
       std::make_shared<nosh::parameter_matrix::keo>(mesh_, thickness_, mvp_)
       ),
+  keo_op_(
+      std::dynamic_pointer_cast<const Tpetra::Operator<double,int,int>>(keo_)
+      ),
   dkeo_dp_(
+      matrix_free_keo ?
+      std::shared_ptr<nosh::parameter_object>(
+        std::make_shared<nosh::parameter_matrix::keo_matrix_free>(
+          mesh_, thickness_, mvp_, deriv_parameter
+          )
+        ) :
+      block_keo ?
+      std::shared_ptr<nosh::parameter_object>(
+        std::make_shared<nosh::parameter_matrix::DkeoDP_block>(
+          mesh_, thickness_, mvp_, deriv_parameter
+          )
+        ) :
       std::make_shared<nosh::parameter_matrix::DkeoDP>(
         mesh_, thickness_, mvp_, deriv_parameter
         )
       ),
+  dkeo_dp_op_(
+      std::dynamic_pointer_cast<const Tpetra::Operator<double,int,int>>(
+        dkeo_dp_
+        )
+      ),
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   eval_model_time_(Teuchos::TimeMonitor::getNewTimer(
         "Nosh: nls::eval_model"
@@ -98,6 +136,11 @@ nls(
   nominal_values_(this->createInArgs()),
   space_(createAlteredSpace())
 {
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      block_keo && matrix_free_keo,
+      "The kinetic energy operator can't be both block and matrix-free."
+      );
+
   // Merge all of the parameters together.
   std::map<std::string, double> params;
   params["g"] = g;
@@ -534,7 +577,7 @@ compute_f_(
 {
   // Compute f_vec = K*x.
   keo_->set_parameters(params, {});
-  keo_->apply(x, f_vec);
+  keo_op_->apply(x, f_vec);
 
   auto x_data = x.getData();
   auto f_data = f_vec.getDataNonConst();
@@ -559,17 +602,16 @@ compute_f_(
 
   const double g = params.at("g");
 
-  const auto thickness_values = thickness_->get_v(params);
-  auto t_data = thickness_values.getData();
-#ifndef NDEBUG
-  TEUCHOS_ASSERT(control_volumes.getMap()->isSameAs(*thickness_values.getMap()));
-#endif
+  // borrowed work vectors, on the map of the control volumes
+  const auto thickness_values =
+    vector_pool::global().get(control_volumes.getMap());
+  thickness_->fill_v(params, *thickness_values);
+  auto t_data = thickness_values->getData();
 
-  const auto scalar_potential_values = scalar_potential_->get_v(params);
-  auto s_data = scalar_potential_values.getData();
-#ifndef NDEBUG
-  TEUCHOS_ASSERT(control_volumes.getMap()->isSameAs(*scalar_potential_values.getMap()));
-#endif
+  const auto scalar_potential_values =
+    vector_pool::global().get(control_volumes.getMap());
+  scalar_potential_->fill_v(params, *scalar_potential_values);
+  auto s_data = scalar_potential_values->getData();
 
   for (size_t k = 0; k < num_my_points; k++) {
     // In principle, mass lumping here suggests to take
@@ -638,7 +680,7 @@ computeDFDP_(
 {
   // f_vec = dK/dp * x.
   dkeo_dp_->set_parameters(params, {});
-  dkeo_dp_->apply(x, f_vec);
+  dkeo_dp_op_->apply(x, f_vec);
 
   auto x_data = x.getData();
   auto f_data = f_vec.getDataNonConst();
@@ -656,11 +698,10 @@ computeDFDP_(
   TEUCHOS_ASSERT_EQUALITY(2*c_data.size(), x_data.size());
 #endif
 
-  const auto thickness_values = thickness_->get_v(params);
-  auto t_data = thickness_values.getData();
-#ifndef NDEBUG
-  TEUCHOS_ASSERT(control_volumes.getMap()->isSameAs(*thickness_values.getMap()));
-#endif
+  const auto thickness_values =
+    vector_pool::global().get(control_volumes.getMap());
+  thickness_->fill_v(params, *thickness_values);
+  auto t_data = thickness_values->getData();
 
   if (param_name.compare("g") == 0) {
     for (int k = 0; k < c_data.size(); k++) {
@@ -25,6 +25,7 @@
 #include <string>
 
 #include <Tpetra_Map.hpp>
+#include <Tpetra_Operator.hpp>
 #include <Tpetra_Vector.hpp>
 #include <Teuchos_ParameterList.hpp>
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
@@ -45,11 +46,7 @@ namespace nosh
   {
     class base;
   }
-  namespace parameter_matrix
-  {
-    class keo;
-    class DkeoDP;
-  }
+  class parameter_object;
 } // namespace nosh
 
 namespace nosh
@@ -66,7 +63,9 @@ public:
     const double g,
     const std::shared_ptr<const nosh::scalar_field::base> &thickness,
     const std::shared_ptr<const Tpetra::Vector<double,int,int>> &initial_x,
-    const std::string & deriv_parameter
+    const std::string & deriv_parameter,
+    const bool block_keo = false,
+    const bool matrix_free_keo = false
     );
 
   virtual
@@ -192,8 +191,14 @@ private:
   const std::shared_ptr<const nosh::scalar_field::base> scalar_potential_;
   const std::shared_ptr<const nosh::scalar_field::base> thickness_;
 
-  const std::shared_ptr<nosh::parameter_matrix::keo> keo_;
-  const std::shared_ptr<nosh::parameter_matrix::DkeoDP> dkeo_dp_;
+  // Kinetic energy operator and its parameter derivative, either in scalar
+  // (keo, DkeoDP) or in 2x2 block CRS storage (keo_block, DkeoDP_block), or
+  // not assembled at all (keo_matrix_free). The preconditioner always
+  // assembles its own.
+  const std::shared_ptr<nosh::parameter_object> keo_;
+  const std::shared_ptr<const Tpetra::Operator<double,int,int>> keo_op_;
+  const std::shared_ptr<nosh::parameter_object> dkeo_dp_;
+  const std::shared_ptr<const Tpetra::Operator<double,int,int>> dkeo_dp_op_;
 
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   const Teuchos::RCP<Teuchos::Time> eval_model_time_;
@@ -12,7 +12,12 @@
 #include "mesh_reader.hpp"
 #include "model.hpp"
 #include "model_evaluator_nls.hpp"
+#include "parameter_matrix_dkeo_dp.hpp"
 #include "parameter_matrix_keo.hpp"
+#include "parameter_matrix_keo_block.hpp"
+#include "parameter_matrix_keo_matrix_free.hpp"
 #include "scalar_field_constant.hpp"
+#include "static_fvm_operator.hpp"
 #include "subdomain.hpp"
 #include "vector_field_explicit_values.hpp"
+#include "vector_pool.hpp"
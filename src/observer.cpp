@@ -24,6 +24,7 @@
 
 #include "model_evaluator_base.hpp"
 #include "mesh.hpp"
+#include "vector_pool.hpp"
 
 namespace nosh
 {
@@ -150,6 +151,13 @@ save_continuation_statistics_(
   paramList.set("(2) Gibbs energy", model_eval_->gibbs_energy(soln));
   paramList.set("(2) ||x||_2 scaled", model_eval_->norm(soln));
 
+  // Work vectors reused (i.e., allocations avoided) and allocated during this
+  // step.
+  auto & pool = vector_pool::global();
+  paramList.set("(3) vector pool reuses", int(pool.num_reuses()));
+  paramList.set("(3) vector pool allocations", int(pool.num_allocations()));
+  pool.reset_counters();
+
   // Write out header.
   if (step_index == 0)
     csv_writer_.write_header(paramList);
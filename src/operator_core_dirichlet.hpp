@@ -18,6 +18,7 @@ namespace nosh {
 
       ~operator_core_dirichlet() override = default;
 
+      //! May be called concurrently, see parallel_for.hpp.
       virtual
       double
       eval(
@@ -3,6 +3,7 @@
 
 #include <Eigen/Dense>
 #include <moab/Core.hpp>
+#include <Teuchos_TestForException.hpp>
 
 #include "parameter_object.hpp"
 
@@ -19,6 +20,7 @@ namespace nosh
 
       ~operator_core_edge() override = default;
 
+      //! May be called concurrently, see parallel_for.hpp.
       virtual
       std::tuple<double,double>
       eval(
@@ -26,6 +28,35 @@ namespace nosh
           const Teuchos::ArrayRCP<const double> & u
           ) const = 0;
 
+      //! Whether eval_multi() is implemented.
+      virtual
+      bool
+      has_eval_multi() const
+      {
+        return false;
+      }
+
+      //! Evaluates the core for num_vectors vectors at once. u is stored
+      //! row-major, u[num_vectors*k + j] being entry k of vector j; the
+      //! contributions for vector j go to vals0[j] and vals1[j].
+      virtual
+      void
+      eval_multi(
+          const moab::EntityHandle & edge,
+          const double * u,
+          const int num_vectors,
+          double * vals0,
+          double * vals1
+          ) const
+      {
+        (void) edge;
+        (void) u;
+        (void) num_vectors;
+        (void) vals0;
+        (void) vals1;
+        TEUCHOS_TEST_FOR_EXCEPT_MSG(true, "eval_multi() not implemented.");
+      }
+
     public:
       const std::set<std::string> subdomain_ids;
   };
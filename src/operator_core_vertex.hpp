@@ -4,6 +4,7 @@
 #include "parameter_object.hpp"
 
 #include <moab/Core.hpp>
+#include <Teuchos_TestForException.hpp>
 
 namespace nosh
 {
@@ -18,6 +19,7 @@ namespace nosh
 
       ~operator_core_vertex() override = default;
 
+      //! May be called concurrently, see parallel_for.hpp.
       virtual
       double
       eval(
@@ -25,6 +27,33 @@ namespace nosh
           const Teuchos::ArrayRCP<const double> & u
           ) const = 0;
 
+      //! Whether eval_multi() is implemented.
+      virtual
+      bool
+      has_eval_multi() const
+      {
+        return false;
+      }
+
+      //! Evaluates the core for num_vectors vectors at once. u is stored
+      //! row-major, u[num_vectors*k + j] being entry k of vector j; the value
+      //! for vector j goes to vals[j].
+      virtual
+      void
+      eval_multi(
+          const moab::EntityHandle & vertex,
+          const double * u,
+          const int num_vectors,
+          double * vals
+          ) const
+      {
+        (void) vertex;
+        (void) u;
+        (void) num_vectors;
+        (void) vals;
+        TEUCHOS_TEST_FOR_EXCEPT_MSG(true, "eval_multi() not implemented.");
+      }
+
     public:
       const std::set<std::string> subdomain_ids;
   };
@@ -0,0 +1,56 @@
+#ifndef NOSH_PARALLEL_FOR_HPP
+#define NOSH_PARALLEL_FOR_HPP
+// =============================================================================
+// includes
+#include <Tpetra_Map.hpp>
+
+#ifdef NOSH_KOKKOS
+#include <Kokkos_Core.hpp>
+#endif
+
+// Whether the loops of nosh::parallel_for run concurrently; the kernels then
+// need colored edge tables to avoid conflicting row updates.
+#if defined(NOSH_KOKKOS) || defined(NOSH_OPENMP)
+#define NOSH_THREADED
+#endif
+
+// fvm_operator and fvm_matrix run their loops over edges and vertices through
+// nosh::parallel_for. With NOSH_THREADED, the evaluation functions of their
+// cores (eval(), eval_multi(), eval_batch() of the operator_core_* and
+// matrix_core_* classes) are hence called concurrently from several threads,
+// each call for a different entity. They're const and must stay free of side
+// effects on shared data (no unsynchronized caches in mutable members), and
+// must not throw.
+
+namespace nosh
+{
+//! Calls f(k) for all k in [0, n). With NOSH_KOKKOS, this is a
+//! Kokkos::parallel_for in the execution space of the Tpetra node (which must
+//! be a host space, e.g., OpenMP or Threads, since the kernels work on host
+//! data), with NOSH_OPENMP an OpenMP loop, and serial otherwise.
+//! f must not throw.
+template<typename F>
+void
+parallel_for(const int n, const F & f)
+{
+#if defined(NOSH_KOKKOS)
+  typedef Tpetra::Map<int,int>::node_type::execution_space execution_space;
+  Kokkos::parallel_for(
+      Kokkos::RangePolicy<execution_space, Kokkos::IndexType<int>>(0, n),
+      f
+      );
+#elif defined(NOSH_OPENMP)
+#pragma omp parallel for schedule(static)
+  for (int k = 0; k < n; k++) {
+    f(k);
+  }
+#else
+  for (int k = 0; k < n; k++) {
+    f(k);
+  }
+#endif
+  return;
+}
+} // namespace nosh
+// =============================================================================
+#endif // NOSH_PARALLEL_FOR_HPP
@@ -0,0 +1,60 @@
+// includes
+#include "parameter_matrix_alpha_cache.hpp"
+
+#include <map>
+#include <string>
+
+#include "mesh.hpp"
+#include "scalar_field_base.hpp"
+
+#include <Teuchos_RCPStdSharedPtrConversions.hpp>
+#include <Tpetra_Vector.hpp>
+
+namespace nosh
+{
+namespace parameter_matrix
+{
+// =============================================================================
+std::vector<double>
+build_alpha_cache(
+    const nosh::mesh & mesh,
+    const nosh::scalar_field::base & thickness
+    )
+{
+  std::map<std::string, double> dummy;
+  const auto thickness_values = thickness.get_v(dummy);
+
+  // The thickness values are given on the nonoverlapping map, but some edges
+  // sit on a processor boundary, so the values are needed on the overlap map.
+  // Make sure to use Import here instead of Export as the vector that we want
+  // to build is overlapping, "larger". If the "smaller", non-overlapping
+  // vector is exported, only the values on the overlap would only be set on
+  // one processor.
+  Tpetra::Vector<double,int,int> thicknessOverlap(
+      Teuchos::rcp(mesh.overlap_map())
+      );
+#ifndef NDEBUG
+  TEUCHOS_ASSERT(thickness_values.getMap()->isSameAs(*mesh.map()));
+#endif
+  thicknessOverlap.doImport(
+      thickness_values,
+      *mesh.importer(),
+      Tpetra::INSERT
+      );
+
+  auto t_data = thicknessOverlap.getData();
+
+  const auto edge_data = mesh.get_edge_data();
+  const auto & edge_lids = mesh.edge_lids;
+  std::vector<double> alpha_cache(edge_lids.size());
+  for (std::size_t k = 0; k < edge_lids.size(); k++) {
+    const double alpha = edge_data[k].covolume / edge_data[k].length;
+    alpha_cache[k] =
+      alpha * 0.5 * (t_data[edge_lids[k][0]] + t_data[edge_lids[k][1]]);
+  }
+
+  return alpha_cache;
+}
+// =============================================================================
+}  // namespace parameter_matrix
+}  // namespace nosh
@@ -0,0 +1,32 @@
+#ifndef NOSH_PARAMETERMATRIX_ALPHACACHE_H
+#define NOSH_PARAMETERMATRIX_ALPHACACHE_H
+
+#include <vector>
+
+// forward declarations
+namespace nosh
+{
+class mesh;
+namespace scalar_field
+{
+class base;
+}
+} // namespace nosh
+
+namespace nosh
+{
+namespace parameter_matrix
+{
+//! The edge coefficients covolume/length, weighted with the thickness
+//! average over the edge, for all edges in mesh.my_edges(). These don't
+//! depend on the parameters, so the kinetic energy operators compute them
+//! only once.
+std::vector<double>
+build_alpha_cache(
+    const nosh::mesh & mesh,
+    const nosh::scalar_field::base & thickness
+    );
+} // namespace parameter_matrix
+} // namespace nosh
+
+#endif // NOSH_PARAMETERMATRIX_ALPHACACHE_H
@@ -9,7 +9,7 @@ namespace parameter_matrix
 // ============================================================================
 base::
 base(const std::shared_ptr<const nosh::mesh> &mesh):
-  Tpetra::CrsMatrix<double,int,int>(mesh->build_complex_graph()),
+  Tpetra::CrsMatrix<double,int,int>(mesh->complex_graph()),
   mesh_(mesh),
   build_parameters_()
 {
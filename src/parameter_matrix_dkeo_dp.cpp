@@ -5,11 +5,11 @@
 #include <string>
 
 #include "mesh.hpp"
+#include "parameter_matrix_alpha_cache.hpp"
 #include "scalar_field_base.hpp"
 #include "vector_field_base.hpp"
 
 #include <Tpetra_Vector.hpp>
-#include <Tpetra_Import.hpp>
 #include <Teuchos_RCPStdSharedPtrConversions.hpp>
 #include <Teuchos_Tuple.hpp>
 
@@ -32,7 +32,7 @@ DkeoDP(
     const std::string & param_name
    ):
   parameter_object(),
-  Tpetra::CrsMatrix<double,int,int>(mesh->build_complex_graph()),
+  Tpetra::CrsMatrix<double,int,int>(mesh->complex_graph()),
   mesh_(mesh),
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   keo_fill_time_(Teuchos::TimeMonitor::getNewTimer("Nosh: DkeoDP::refill_")),
@@ -87,7 +87,8 @@ refill_(
 
   const std::vector<edge> edges = mesh_->my_edges();
   if (!alpha_cache_up_to_date_) {
-    this->build_alpha_cache_(edges, mesh_->get_edge_data());
+    alpha_cache_ = build_alpha_cache(*mesh_, *thickness_);
+    alpha_cache_up_to_date_ = true;
   }
 
   double v[3];
@@ -154,53 +155,5 @@ refill_(
   return;
 }
 // =============================================================================
-void
-DkeoDP::
-build_alpha_cache_(
-    const std::vector<edge> & edges,
-    const std::vector<mesh::edge_data> & edge_data
-    ) const
-{
-  // This routine serves the one and only purpose of caching the thickness
-  // average. The cache is used in every call to this->fill().  This is
-  // somewhat problematic since the map of V is principally not known here.
-  // Also, it is typically a nonoverlapping map whereas some edges do sit on a
-  // processor boundary, so actually the values of V are needed in an
-  // overlapping map.
-  // Fair enough. Let's distribute the vales of V to an overlapping map here.
-  alpha_cache_ = std::vector<double>(edges.size());
-
-  std::map<std::string, double> dummy;
-  const auto thickness_values = thickness_->get_v(dummy);
-
-  auto overlapMap = mesh_->overlap_map();
-  // We need to make sure that thickness_values are distributed on the overlap
-  // map.
-  // Make sure to use Import here instead of Export as the vector that we want
-  // to build is overlapping, "larger". If the "smaller", non-overlapping
-  // vector is exported, only the values on the overlap would only be set on
-  // one processor.
-  Tpetra::Vector<double,int,int> thicknessOverlap(Teuchos::rcp(overlapMap));
-  Tpetra::Import<int,int> importer(
-      thickness_values.getMap(),
-      Teuchos::rcp(overlapMap)
-      );
-  thicknessOverlap.doImport(thickness_values, importer, Tpetra::INSERT);
-
-  auto t_data = thicknessOverlap.getData();
-
-  for (std::size_t k = 0; k < edges.size(); k++) {
-    // Get the ID of the edge endpoints in the map of get_v(). Well...
-    const int i0 = mesh_->local_index(std::get<0>(edges[k]));
-    const int i1 = mesh_->local_index(std::get<1>(edges[k]));
-    // Update cache.
-    const double alpha = edge_data[k].covolume / edge_data[k].length;
-    alpha_cache_[k] = alpha * 0.5 * (t_data[i0] + t_data[i1]);
-  }
-
-  alpha_cache_up_to_date_ = true;
-  return;
-}
-// =============================================================================
 }  // namespace parameter_matrix
 }  // namespace nosh
@@ -58,12 +58,6 @@ private:
       const std::map<std::string, std::shared_ptr<const Tpetra::Vector<double, int, int>>> & vector_params
       );
 
-  void
-  build_alpha_cache_(
-      const std::vector<edge> & edges,
-      const std::vector<mesh::edge_data> & edge_data
-      ) const;
-
 private:
   const std::shared_ptr<const nosh::mesh> mesh_;
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
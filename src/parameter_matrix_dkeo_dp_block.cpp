@@ -0,0 +1,151 @@
+// includes
+#include "parameter_matrix_dkeo_dp_block.hpp"
+
+#include <map>
+#include <string>
+
+#include "mesh.hpp"
+#include "parameter_matrix_alpha_cache.hpp"
+#include "scalar_field_base.hpp"
+#include "vector_field_base.hpp"
+
+#include <Teuchos_RCPStdSharedPtrConversions.hpp>
+#include <Tpetra_Vector.hpp>
+
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+#include <Teuchos_TimeMonitor.hpp>
+#endif
+
+namespace nosh
+{
+namespace parameter_matrix
+{
+// =============================================================================
+DkeoDP_block::
+DkeoDP_block(
+    const std::shared_ptr<const nosh::mesh> &mesh,
+    const std::shared_ptr<const nosh::scalar_field::base> &thickness,
+    const std::shared_ptr<nosh::vector_field::base> &mvp,
+    const std::string & param_name
+   ):
+  parameter_object(),
+  Tpetra::Experimental::BlockCrsMatrix<double,int,int>(*mesh->graph(), 2),
+  mesh_(mesh),
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  keo_fill_time_(
+      Teuchos::TimeMonitor::getNewTimer("Nosh: DkeoDP_block::refill_")
+      ),
+#endif
+  thickness_(thickness),
+  mvp_(mvp),
+  overlap_matrix_(
+      !mesh->is_distributed() ?
+      nullptr :
+      std::make_shared<Tpetra::Experimental::BlockCrsMatrix<double,int,int>>(
+        *mesh->overlap_graph(), 2
+        )
+      ),
+  exporter_(
+      overlap_matrix_ ?
+      mesh->exporter() :
+      Teuchos::null
+      ),
+  alpha_cache_(),
+  alpha_cache_up_to_date_(false),
+  param_name_(param_name)
+{
+}
+// =============================================================================
+DkeoDP_block::
+~DkeoDP_block()
+{
+}
+// =============================================================================
+std::map<std::string, double>
+DkeoDP_block::
+get_scalar_parameters() const
+{
+  return mvp_->get_scalar_parameters();
+}
+// =============================================================================
+void
+DkeoDP_block::
+refill_(
+    const std::map<std::string, double> & params,
+    const std::map<std::string, std::shared_ptr<const Tpetra::Vector<double, int, int>>> & vector_params
+    )
+{
+  (void) vector_params;
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  Teuchos::TimeMonitor tm(*keo_fill_time_);
+#endif
+
+  mvp_->set_parameters(params);
+
+#ifndef NDEBUG
+  TEUCHOS_ASSERT(mesh_);
+  TEUCHOS_ASSERT(thickness_);
+  TEUCHOS_ASSERT(mvp_);
+#endif
+
+  const auto & edge_lids = mesh_->edge_lids;
+  if (!alpha_cache_up_to_date_) {
+    alpha_cache_ = build_alpha_cache(*mesh_, *thickness_);
+    alpha_cache_up_to_date_ = true;
+  }
+
+  Tpetra::Experimental::BlockCrsMatrix<double,int,int> & A =
+    overlap_matrix_ ?
+    *overlap_matrix_ :
+    static_cast<Tpetra::Experimental::BlockCrsMatrix<double,int,int>&>(*this);
+
+  A.setAllToScalar(0.0);
+
+  // Row-major 2x2 block. The derivative of the diagonal blocks vanishes, so
+  // only the off-diagonal blocks are summed into.
+  double offdiag[4];
+  for (std::size_t k = 0; k < edge_lids.size(); k++) {
+    // Derivative of the coupling in keo_block::refill_() with respect to the
+    // parameter param_name_, which only enters through a_int.
+    const double a_int = mvp_->get_edge_projection(k);
+    const double dAdPInt = mvp_->get_d_edge_projection_dp(k, param_name_);
+    double sin_a_int, cos_a_int;
+    sincos(a_int, &sin_a_int, &cos_a_int);
+    const double v0 =  dAdPInt * sin_a_int * alpha_cache_[k];
+    const double v1 = -dAdPInt * cos_a_int * alpha_cache_[k];
+
+    const int i0 = edge_lids[k][0];
+    const int i1 = edge_lids[k][1];
+
+    offdiag[0] = v0;
+    offdiag[1] = v1;
+    offdiag[2] = -v1;
+    offdiag[3] = v0;
+    int num = A.sumIntoLocalValues(i0, &i1, offdiag, 1);
+
+    offdiag[1] = -v1;
+    offdiag[2] = v1;
+    num += A.sumIntoLocalValues(i1, &i0, offdiag, 1);
+#ifndef NDEBUG
+    TEUCHOS_TEST_FOR_EXCEPT_MSG(
+        num != 2,
+        "Error trying to sum into the blocks of edge (" << i0 << ", " << i1
+        << ") on proc " << mesh_->comm->getRank()
+        << ". Only " << num << " blocks found."
+        );
+#else
+    (void) num;
+#endif
+  }
+
+  if (overlap_matrix_) {
+    // Add up the contributions of the shared vertices at their owners.
+    this->setAllToScalar(0.0);
+    this->doExport(*overlap_matrix_, *exporter_, Tpetra::ADD);
+  }
+
+  return;
+}
+// =============================================================================
+}  // namespace parameter_matrix
+}  // namespace nosh
@@ -1,13 +1,18 @@
 // includes
 #include "parameter_matrix_keo.hpp"
 
+#include <array>
+#include <cmath>
 #include <map>
 #include <string>
 
 #include "mesh.hpp"
+#include "parameter_matrix_alpha_cache.hpp"
 #include "scalar_field_base.hpp"
 #include "vector_field_base.hpp"
 
+#include <Kokkos_Core.hpp>
+#include <Teuchos_ParameterList.hpp>
 #include <Teuchos_RCPStdSharedPtrConversions.hpp>
 #include <Tpetra_Vector.hpp>
 
@@ -29,7 +34,7 @@ keo(
     const std::shared_ptr<nosh::vector_field::base> &mvp
    ):
   parameter_object(),
-  Tpetra::CrsMatrix<double,int,int>(mesh->build_complex_graph()),
+  Tpetra::CrsMatrix<double,int,int>(mesh->complex_graph()),
   mesh_(mesh),
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
   keo_fill_time_(Teuchos::TimeMonitor::getNewTimer("Nosh: keo::fill_")),
@@ -37,7 +42,15 @@ keo(
   thickness_(thickness),
   mvp_(mvp),
   alpha_cache_(),
-  alpha_cache_up_to_date_(false)
+  alpha_cache_up_to_date_(false),
+  edge_projections_(),
+  overlap_matrix_(
+      !mesh->is_distributed() ?
+      nullptr :
+      std::make_shared<Tpetra::CrsMatrix<double,int,int>>(
+        mesh->overlap_complex_graph()
+        )
+      )
 {
 }
 // =============================================================================
@@ -83,151 +96,121 @@ refill_(
   Teuchos::TimeMonitor tm(*keo_fill_time_);
 #endif
 
-  this->resumeFill();
-
   mvp_->set_parameters(params);
 
-  this->setAllToScalar(0.0);
-
 #ifndef NDEBUG
   TEUCHOS_ASSERT(mesh_);
   TEUCHOS_ASSERT(thickness_);
   TEUCHOS_ASSERT(mvp_);
 #endif
 
-  const std::vector<edge> edges = mesh_->my_edges();
+  // The parameters only enter through the edge projections, i.e., the
+  // phases; the sparsity pattern and the alpha_cache_ stay the same.
   if (!alpha_cache_up_to_date_) {
-    this->build_alpha_cache_(edges, mesh_->get_edge_data());
+    alpha_cache_ = build_alpha_cache(*mesh_, *thickness_);
+    alpha_cache_up_to_date_ = true;
   }
-
-  double v[3];
-  //const vector_fieldType & coords_field = mesh_->get_node_field("coordinates");
-  // Loop over all edges.
-  for (std::size_t k = 0; k < edges.size(); k++) {
-    // Compute the integral
-    //
-    //    I = \int_{x0}^{xj} (xj-x0).A(x) / |xj-x0| dx
-    //
-    // numerically by the midpoint rule, i.e.,
-    //
-    //    I ~ |xj-x0| * (xj-x0) . A(0.5*(xj+x0)) / |xj-x0|.
-    //
-    // Project vector field onto the edge.
-    // Instead of first computing the projection over the normalized edge
-    // and then multiply it with the edge length, don't normalize the
-    // edge vector.
-    // We'd like to insert the 2x2 matrix
-    //
-    //     [   alpha                 , - alpha * exp(-IM * a_int) ]
-    //     [ - alpha * exp(IM * a_int),   alpha                   ]
-    //
-    // at the indices   [ nodeIndices[0], nodeIndices[1] ] for every index pair
-    // that shares and edge.
-    // Do that now, just blockwise for real and imaginary part.
-
-    const double a_int = mvp_->get_edge_projection(k);
-
-    //// ----
-    //// get edge coords (cache this)
-    //// Now: midpoint rule
-    //const Eigen::Vector3d x0 =
-    //  mesh_->get_node_value(coords_field, std::get<0>(edges[k]));
-    //const Eigen::Vector3d x1 =
-    //  mesh_->get_node_value(coords_field, std::get<1>(edges[k]));
-    //const double a_int2 = integrate1d_(*mvp_, x0, x1);
-
-    //TEUCHOS_TEST_FOR_EXCEPT_MSG(
-    //    fabs(a_int - a_int2) > 1.0e-10,
-    //    a_int << " != " << a_int2 << " diff  = " << a_int - a_int2
-    //   );
-
-    // ----
-    // Fill v with
-    // Re(-exp(i Aint))
-    // Im(-exp(i Aint))
-    // 1.0
-    double sin_a_int, cos_a_int;
-    sincos(a_int, &sin_a_int, &cos_a_int);
-    v[0] = -cos_a_int * alpha_cache_[k];
-    v[1] = -sin_a_int * alpha_cache_[k];
-    v[2] = alpha_cache_[k];
-
-    auto vals = Teuchos::tuple(
-      Teuchos::tuple(v[2],  0.0,   v[0], v[1]),
-      Teuchos::tuple( 0.0,  v[2], -v[1], v[0]),
-      Teuchos::tuple(v[0], -v[1],  v[2],  0.0),
-      Teuchos::tuple(v[1],  v[0],   0.0, v[2])
-      );
-
-    const Teuchos::Tuple<int,4> & idx = mesh_->edge_gids_complex[k];
-
-    for (int i = 0; i < 4; i++) {
-      const int num = this->sumIntoGlobalValues(idx[i], idx, vals[i]);
-#ifndef NDEBUG
-      TEUCHOS_TEST_FOR_EXCEPT_MSG(
-          num != 4,
-          "Error trying to sum into colums "
-          << " " << idx[0]
-          << " " << idx[1]
-          << " " << idx[2]
-          << " " << idx[3]
-          << " in row " << idx[i]
-          << " on proc " << mesh_->comm->getRank()
-          << ". Only " << num << " entries inserted."
-          );
-#endif
+  edge_projections_.resize(alpha_cache_.size());
+  mvp_->get_edge_projections(edge_projections_);
+
+  if (overlap_matrix_) {
+    // The edges with ghost vertices contribute to rows owned elsewhere, so
+    // assemble on the overlap and add up at the owners.
+    this->write_values_(overlap_matrix_->getLocalMatrix().values);
+    if (!overlap_matrix_->isFillComplete()) {
+      overlap_matrix_->fillComplete();
     }
+    const bool is_refill = this->isFillComplete();
+    this->resumeFill();
+    this->setAllToScalar(0.0);
+    this->doExport(*overlap_matrix_, *mesh_->complex_exporter(), Tpetra::ADD);
+    auto fill_params = Teuchos::parameterList();
+    fill_params->set("No Nonlocal Changes", is_refill);
+    this->fillComplete(fill_params);
+    return;
+  }
+
+  // All rows are local; the values are overwritten in place and the matrix
+  // stays fill-complete.
+  this->write_values_(this->getLocalMatrix().values);
+  if (!this->isFillComplete()) {
+    this->fillComplete();
   }
-  this->fillComplete();
 
   return;
 }
 // =============================================================================
 void
 keo::
-build_alpha_cache_(
-    const std::vector<edge> & edges,
-    const std::vector<nosh::mesh::edge_data> & edge_data
-    ) const
+write_values_(const values_type & values) const
 {
-  // This routine serves the one and only purpose of caching the thickness
-  // average. The cache is used in every call to this->fill().  This is
-  // somewhat problematic since the map of V is principally not known here.
-  // Also, it is typically a nonoverlapping map whereas some edges do sit on a
-  // processor boundary, so actually the values of V are needed in an
-  // overlapping map.
-  // Fair enough. Let's distribute the vales of V to an overlapping map here.
-  alpha_cache_ = std::vector<double>(edges.size());
-
-  std::map<std::string, double> dummy;
-  const auto thickness_values = thickness_->get_v(dummy);
-
-  auto overlapMap = mesh_->overlap_map();
-  // We need to make sure that thickness_values are distributed on the overlap
-  // map.
-  // Make sure to use Import here instead of Export as the vector that we want
-  // to build is overlapping, "larger". If the "smaller", non-overlapping
-  // vector is exported, only the values on the overlap would only be set on
-  // one processor.
-  Tpetra::Vector<double,int,int> thicknessOverlap(Teuchos::rcp(overlapMap));
-  Tpetra::Import<int,int> importer(
-      thickness_values.getMap(),
-      Teuchos::rcp(overlapMap)
-      );
-  thicknessOverlap.doImport(thickness_values, importer, Tpetra::INSERT);
-
-  auto t_data = thicknessOverlap.getData();
-
-  for (std::size_t k = 0; k < edges.size(); k++) {
-    // Get the ID of the edge endpoints in the map of get_v(). Well...
-    const int i0 = mesh_->local_index(std::get<0>(edges[k]));
-    const int i1 = mesh_->local_index(std::get<1>(edges[k]));
-    // Update cache.
-    const double alpha = edge_data[k].covolume / edge_data[k].length;
-    alpha_cache_[k] = alpha * 0.5 * (t_data[i0] + t_data[i1]);
+  // For every edge with the integral
+  //
+  //    a_int = \int_{x0}^{x1} (x1-x0).A(x) / |x1-x0| dx
+  //
+  // of the vector potential (see vector_field::base::get_edge_projection()),
+  // the 2x2 complex block
+  //
+  //     [   alpha                 , - alpha * exp(-IM * a_int) ]
+  //     [ - alpha * exp(IM * a_int),   alpha                   ]
+  //
+  // is added at the vertices of the edge, split into real and imaginary
+  // parts. That's the 4x4 block
+  //
+  //     [ v2,   0,  v0,  v1 ]
+  //     [  0,  v2, -v1,  v0 ]
+  //     [ v0, -v1,  v2,   0 ]
+  //     [ v1,  v0,   0,  v2 ]
+  //
+  // with v0 = Re(-alpha exp(IM a_int)), v1 = Im(-alpha exp(IM a_int)),
+  // v2 = alpha, written directly at the precomputed value offsets.
+  const auto & offsets = mesh_->overlap_complex_crs_offsets().edges;
+  const int num_edges = offsets.size();
+#ifndef NDEBUG
+  TEUCHOS_ASSERT_EQUALITY(edge_projections_.size(), offsets.size());
+  TEUCHOS_ASSERT_EQUALITY(alpha_cache_.size(), offsets.size());
+#endif
+
+  Kokkos::deep_copy(values, 0.0);
+
+  std::array<double, batch_size> cos_a;
+  std::array<double, batch_size> sin_a;
+  for (int first = 0; first < num_edges; first += batch_size) {
+    const int n = num_edges - first < batch_size ?
+      num_edges - first : batch_size;
+    const double * a_int = &edge_projections_[first];
+    // Unlike sincos(), separate sin and cos loops can be vectorized with the
+    // SIMD math library of the compiler.
+#ifdef NOSH_OPENMP
+#pragma omp simd
+#endif
+    for (int j = 0; j < n; j++) {
+      cos_a[j] = std::cos(a_int[j]);
+      sin_a[j] = std::sin(a_int[j]);
+    }
+
+    for (int j = 0; j < n; j++) {
+      const int k = first + j;
+      const double v0 = -cos_a[j] * alpha_cache_[k];
+      const double v1 = -sin_a[j] * alpha_cache_[k];
+      const double v2 = alpha_cache_[k];
+      const auto & o = offsets[k];
+      // The zeros are left out.
+      values(o[0]) += v2;
+      values(o[2]) += v0;
+      values(o[3]) += v1;
+      values(o[5]) += v2;
+      values(o[6]) -= v1;
+      values(o[7]) += v0;
+      values(o[8]) += v0;
+      values(o[9]) -= v1;
+      values(o[10]) += v2;
+      values(o[12]) += v1;
+      values(o[13]) += v0;
+      values(o[15]) += v2;
+    }
   }
 
-  alpha_cache_up_to_date_ = true;
   return;
 }
 // =============================================================================
@@ -2,7 +2,9 @@
 #define NOSH_MATRIXBUILDER_KEO_H
 
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #ifdef NOSH_TEUCHOS_TIME_MONITOR
 #include <Teuchos_Time.hpp>
@@ -59,11 +61,16 @@ private:
       const std::map<std::string, std::shared_ptr<const Tpetra::Vector<double, int, int>>> & vector_params
       );
 
+  typedef Tpetra::CrsMatrix<double,int,int>::local_matrix_type::values_type
+    values_type;
+
+  //! number of edges per vectorized sin/cos evaluation
+  static constexpr int batch_size = 64;
+
+  //! Zeros values and adds the edge blocks at the offsets precomputed by the
+  //! mesh, for a matrix on mesh::overlap_complex_graph().
   void
-  build_alpha_cache_(
-      const std::vector<edge> & edges,
-      const std::vector<nosh::mesh::edge_data> & edge_data
-      ) const;
+  write_values_(const values_type & values) const;
 
   double
   integrate1d_(
@@ -82,6 +89,10 @@ private:
 
   mutable std::vector<double> alpha_cache_;
   mutable bool alpha_cache_up_to_date_;
+  std::vector<double> edge_projections_;
+
+  //! Local assembly target if there are ghost vertices, otherwise null.
+  const std::shared_ptr<Tpetra::CrsMatrix<double,int,int>> overlap_matrix_;
 };
 } // namespace parameter_matrix
 } // namespace nosh
@@ -0,0 +1,191 @@
+// includes
+#include "parameter_matrix_keo_block.hpp"
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <string>
+
+#include "mesh.hpp"
+#include "parameter_matrix_alpha_cache.hpp"
+#include "scalar_field_base.hpp"
+#include "vector_field_base.hpp"
+
+#include <Teuchos_RCPStdSharedPtrConversions.hpp>
+#include <Tpetra_Vector.hpp>
+
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+#include <Teuchos_TimeMonitor.hpp>
+#endif
+
+namespace nosh
+{
+namespace parameter_matrix
+{
+// =============================================================================
+keo_block::
+keo_block(
+    const std::shared_ptr<const nosh::mesh> &mesh,
+    const std::shared_ptr<const nosh::scalar_field::base> &thickness,
+    const std::shared_ptr<nosh::vector_field::base> &mvp
+   ):
+  parameter_object(),
+  Tpetra::Experimental::BlockCrsMatrix<double,int,int>(*mesh->graph(), 2),
+  mesh_(mesh),
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  keo_fill_time_(Teuchos::TimeMonitor::getNewTimer("Nosh: keo_block::fill_")),
+#endif
+  thickness_(thickness),
+  mvp_(mvp),
+  overlap_matrix_(
+      !mesh->is_distributed() ?
+      nullptr :
+      std::make_shared<Tpetra::Experimental::BlockCrsMatrix<double,int,int>>(
+        *mesh->overlap_graph(), 2
+        )
+      ),
+  exporter_(
+      overlap_matrix_ ?
+      mesh->exporter() :
+      Teuchos::null
+      ),
+  alpha_cache_(),
+  alpha_cache_up_to_date_(false),
+  block_offsets_(),
+  edge_projections_()
+{
+  // The blocks are stored row by row in the order of the graph entries, each
+  // block row-major. Block p of the local graph thus starts at value 4*p.
+  const auto & offsets = mesh->overlap_crs_offsets().edges;
+  block_offsets_.resize(offsets.size());
+  for (size_t k = 0; k < offsets.size(); k++) {
+    for (int i = 0; i < 4; i++) {
+      block_offsets_[k][i] = 4 * offsets[k][i];
+    }
+  }
+}
+// =============================================================================
+keo_block::
+~keo_block()
+{
+}
+// =============================================================================
+std::map<std::string, double>
+keo_block::
+get_scalar_parameters() const
+{
+  return mvp_->get_scalar_parameters();
+}
+// =============================================================================
+void
+keo_block::
+refill_(
+    const std::map<std::string, double> & params,
+    const std::map<std::string, std::shared_ptr<const Tpetra::Vector<double, int, int>>> & vector_params
+    )
+{
+  (void) vector_params;
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  Teuchos::TimeMonitor tm(*keo_fill_time_);
+#endif
+
+  mvp_->set_parameters(params);
+
+#ifndef NDEBUG
+  TEUCHOS_ASSERT(mesh_);
+  TEUCHOS_ASSERT(thickness_);
+  TEUCHOS_ASSERT(mvp_);
+#endif
+
+  if (!alpha_cache_up_to_date_) {
+    alpha_cache_ = build_alpha_cache(*mesh_, *thickness_);
+    alpha_cache_up_to_date_ = true;
+  }
+  edge_projections_.resize(alpha_cache_.size());
+  mvp_->get_edge_projections(edge_projections_);
+
+  // Assemble the local contributions. Both the graph and the overlap graph
+  // have the vertex local IDs as row and column indices.
+  Tpetra::Experimental::BlockCrsMatrix<double,int,int> & A =
+    overlap_matrix_ ?
+    *overlap_matrix_ :
+    static_cast<Tpetra::Experimental::BlockCrsMatrix<double,int,int>&>(*this);
+
+  A.setAllToScalar(0.0);
+
+  const int num_edges = block_offsets_.size();
+#ifndef NDEBUG
+  TEUCHOS_ASSERT_EQUALITY(edge_projections_.size(), block_offsets_.size());
+  TEUCHOS_ASSERT_EQUALITY(alpha_cache_.size(), block_offsets_.size());
+#endif
+  // the values of all local blocks, starting with the ones of row 0
+  double * values = nullptr;
+  if (num_edges > 0) {
+    const int * cols;
+    int num_cols;
+    A.getLocalRowView(0, cols, values, num_cols);
+  }
+
+  std::array<double, batch_size> cos_a;
+  std::array<double, batch_size> sin_a;
+  for (int first = 0; first < num_edges; first += batch_size) {
+    const int n = num_edges - first < batch_size ?
+      num_edges - first : batch_size;
+    const double * a_int = &edge_projections_[first];
+    // as in keo::write_values_()
+#ifdef NOSH_OPENMP
+#pragma omp simd
+#endif
+    for (int j = 0; j < n; j++) {
+      cos_a[j] = std::cos(a_int[j]);
+      sin_a[j] = std::sin(a_int[j]);
+    }
+
+    for (int j = 0; j < n; j++) {
+      // The complex coupling
+      //
+      //     [   alpha                 , - alpha * exp(-IM * a_int) ]
+      //     [ - alpha * exp(IM * a_int),   alpha                   ]
+      //
+      // of the two edge vertices, cf. keo::write_values_(). Every complex
+      // entry z becomes the 2x2 block
+      //
+      //     [ Re(z), -Im(z) ]
+      //     [ Im(z),  Re(z) ].
+      //
+      // The zeros are left out.
+      const int k = first + j;
+      const double v0 = -cos_a[j] * alpha_cache_[k];
+      const double v1 = -sin_a[j] * alpha_cache_[k];
+      const double v2 = alpha_cache_[k];
+      const auto & o = block_offsets_[k];
+      // (i0, i0)
+      values[o[0]] += v2;
+      values[o[0] + 3] += v2;
+      // (i0, i1): -alpha * exp(-IM * a_int)
+      values[o[1]] += v0;
+      values[o[1] + 1] += v1;
+      values[o[1] + 2] -= v1;
+      values[o[1] + 3] += v0;
+      // (i1, i0): -alpha * exp(IM * a_int)
+      values[o[2]] += v0;
+      values[o[2] + 1] -= v1;
+      values[o[2] + 2] += v1;
+      values[o[2] + 3] += v0;
+      // (i1, i1)
+      values[o[3]] += v2;
+      values[o[3] + 3] += v2;
+    }
+  }
+
+  if (overlap_matrix_) {
+    // Add up the contributions of the shared vertices at their owners.
+    this->setAllToScalar(0.0);
+    this->doExport(*overlap_matrix_, *exporter_, Tpetra::ADD);
+  }
+
+  return;
+}
+// =============================================================================
+}  // namespace parameter_matrix
+}  // namespace nosh
@@ -0,0 +1,97 @@
+#ifndef NOSH_PARAMETERMATRIX_KEOBLOCK_H
+#define NOSH_PARAMETERMATRIX_KEOBLOCK_H
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+#include <Teuchos_Time.hpp>
+#endif
+
+#include <Tpetra_Experimental_BlockCrsMatrix.hpp>
+#include <Tpetra_Export.hpp>
+
+#include "mesh.hpp"
+#include "parameter_object.hpp"
+
+// forward declarations
+namespace nosh
+{
+class mesh;
+namespace scalar_field
+{
+class base;
+}
+namespace vector_field
+{
+class base;
+}
+} // namespace nosh
+
+namespace nosh
+{
+namespace parameter_matrix
+{
+
+//! Kinetic energy operator in block CRS storage. Every vertex carries a 2x2
+//! block (real and imaginary part), so the column indices are stored once per
+//! vertex pair instead of four times per complex coupling as in keo. The
+//! operator acts on vectors on the mesh's complex_map().
+class keo_block:
+  public nosh::parameter_object,
+  public Tpetra::Experimental::BlockCrsMatrix<double,int,int>
+{
+public:
+  keo_block(
+      const std::shared_ptr<const nosh::mesh> &mesh,
+      const std::shared_ptr<const nosh::scalar_field::base> &thickness,
+      const std::shared_ptr<nosh::vector_field::base> &mvp
+     );
+
+  // Destructor.
+  ~keo_block();
+
+  //! Gets the initial parameters from this module.
+  virtual
+  std::map<std::string, double>
+  get_scalar_parameters() const;
+
+protected:
+private:
+  void
+  refill_(
+      const std::map<std::string, double> & scalar_params,
+      const std::map<std::string, std::shared_ptr<const Tpetra::Vector<double, int, int>>> & vector_params
+      );
+
+  //! number of edges per batch of sin and cos evaluations
+  static constexpr int batch_size = 64;
+
+private:
+  const std::shared_ptr<const nosh::mesh> mesh_;
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  const Teuchos::RCP<Teuchos::Time> keo_fill_time_;
+#endif
+  const std::shared_ptr<const nosh::scalar_field::base> thickness_;
+  const std::shared_ptr<nosh::vector_field::base> mvp_;
+
+  // Local assembly target and its exporter if not all local vertices are
+  // owned; null otherwise.
+  const std::shared_ptr<Tpetra::Experimental::BlockCrsMatrix<double,int,int>>
+    overlap_matrix_;
+  const Teuchos::RCP<const Tpetra::Export<int,int>> exporter_;
+
+  mutable std::vector<double> alpha_cache_;
+  mutable bool alpha_cache_up_to_date_;
+
+  //! Position of the (v0,v0), (v0,v1), (v1,v0), and (v1,v1) blocks of each
+  //! edge in the values of the local matrix
+  std::vector<std::array<size_t,4>> block_offsets_;
+  std::vector<double> edge_projections_;
+};
+} // namespace parameter_matrix
+} // namespace nosh
+
+#endif // NOSH_PARAMETERMATRIX_KEOBLOCK_H
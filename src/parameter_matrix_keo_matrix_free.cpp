@@ -0,0 +1,234 @@
+// includes
+#include "parameter_matrix_keo_matrix_free.hpp"
+
+#include <cmath>
+#include <map>
+#include <string>
+
+#include "mesh.hpp"
+#include "parameter_matrix_alpha_cache.hpp"
+#include "scalar_field_base.hpp"
+#include "vector_field_base.hpp"
+
+#include <Teuchos_RCPStdSharedPtrConversions.hpp>
+#include <Tpetra_Vector.hpp>
+
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+#include <Teuchos_TimeMonitor.hpp>
+#endif
+
+namespace nosh
+{
+namespace parameter_matrix
+{
+// =============================================================================
+keo_matrix_free::
+keo_matrix_free(
+    const std::shared_ptr<const nosh::mesh> &mesh,
+    const std::shared_ptr<const nosh::scalar_field::base> &thickness,
+    const std::shared_ptr<nosh::vector_field::base> &mvp,
+    const std::string & param_name
+   ):
+  parameter_object(),
+  mesh_(mesh),
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  keo_fill_time_(Teuchos::TimeMonitor::getNewTimer(
+        "Nosh: keo_matrix_free::refill_"
+        )),
+  keo_apply_time_(Teuchos::TimeMonitor::getNewTimer(
+        "Nosh: keo_matrix_free::apply"
+        )),
+#endif
+  thickness_(thickness),
+  mvp_(mvp),
+  param_name_(param_name),
+  alpha_cache_(),
+  alpha_cache_up_to_date_(false),
+  edge_values_(),
+  is_distributed_(mesh->is_distributed()),
+  x_overlap_(),
+  y_overlap_(),
+  y_export_()
+{
+}
+// =============================================================================
+keo_matrix_free::
+~keo_matrix_free()
+{
+}
+// =============================================================================
+std::map<std::string, double>
+keo_matrix_free::
+get_scalar_parameters() const
+{
+  return mvp_->get_scalar_parameters();
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::Map<int,int>>
+keo_matrix_free::
+getDomainMap() const
+{
+  return Teuchos::rcp(mesh_->complex_map());
+}
+// =============================================================================
+Teuchos::RCP<const Tpetra::Map<int,int>>
+keo_matrix_free::
+getRangeMap() const
+{
+  return Teuchos::rcp(mesh_->complex_map());
+}
+// =============================================================================
+void
+keo_matrix_free::
+refill_(
+    const std::map<std::string, double> & params,
+    const std::map<std::string, std::shared_ptr<const Tpetra::Vector<double, int, int>>> & vector_params
+    )
+{
+  (void) vector_params;
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  Teuchos::TimeMonitor tm(*keo_fill_time_);
+#endif
+
+  mvp_->set_parameters(params);
+
+#ifndef NDEBUG
+  TEUCHOS_ASSERT(mesh_);
+  TEUCHOS_ASSERT(thickness_);
+  TEUCHOS_ASSERT(mvp_);
+#endif
+
+  if (!alpha_cache_up_to_date_) {
+    alpha_cache_ = build_alpha_cache(*mesh_, *thickness_);
+    alpha_cache_up_to_date_ = true;
+  }
+
+  const size_t num_edges = alpha_cache_.size();
+  std::vector<double> a_int(num_edges);
+  mvp_->get_edge_projections(a_int);
+
+  edge_values_.resize(num_edges);
+  if (param_name_.empty()) {
+    // v0 + IM * v1 = -alpha * exp(IM * a_int), v2 = alpha
+    for (size_t k = 0; k < num_edges; k++) {
+      edge_values_[k] = {{
+        -std::cos(a_int[k]) * alpha_cache_[k],
+        -std::sin(a_int[k]) * alpha_cache_[k],
+        alpha_cache_[k]
+      }};
+    }
+  } else {
+    // the derivative with respect to param_name_
+    for (size_t k = 0; k < num_edges; k++) {
+      const double d_a_int = mvp_->get_d_edge_projection_dp(k, param_name_);
+      edge_values_[k] = {{
+         d_a_int * std::sin(a_int[k]) * alpha_cache_[k],
+        -d_a_int * std::cos(a_int[k]) * alpha_cache_[k],
+        0.0
+      }};
+    }
+  }
+
+  return;
+}
+// =============================================================================
+void
+keo_matrix_free::
+apply(
+    const Tpetra::MultiVector<double,int,int> & x,
+    Tpetra::MultiVector<double,int,int> & y,
+    Teuchos::ETransp mode,
+    double alpha,
+    double beta
+    ) const
+{
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  Teuchos::TimeMonitor tm(*keo_apply_time_);
+#endif
+  TEUCHOS_ASSERT_EQUALITY(x.getNumVectors(), y.getNumVectors());
+  // The operator is symmetric.
+  (void) mode;
+
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(
+      edge_values_.empty() && !mesh_->edge_lids_complex.empty(),
+      "Parameters not set."
+      );
+
+  // Work on the local (overlap) DOFs; with more than one process, the ghost
+  // values of x are imported first, and the contributions to the ghost rows
+  // are added up at the owners afterwards. The export replaces the owned
+  // entries of its target, so it goes to y_export_, and beta * y is added
+  // after that.
+  Teuchos::RCP<const Tpetra::MultiVector<double,int,int>> xo =
+    Teuchos::rcpFromRef(x);
+  Teuchos::RCP<Tpetra::MultiVector<double,int,int>> yo;
+  if (is_distributed_) {
+    if (x_overlap_.is_null() || x_overlap_->getNumVectors() != x.getNumVectors()) {
+      const auto overlap_map = Teuchos::rcp(mesh_->overlap_complex_map());
+      x_overlap_ = Teuchos::rcp(new Tpetra::MultiVector<double,int,int>(
+            overlap_map, x.getNumVectors()
+            ));
+      y_overlap_ = Teuchos::rcp(new Tpetra::MultiVector<double,int,int>(
+            overlap_map, x.getNumVectors()
+            ));
+      y_export_ = Teuchos::rcp(new Tpetra::MultiVector<double,int,int>(
+            Teuchos::rcp(mesh_->complex_map()), x.getNumVectors()
+            ));
+    }
+    x_overlap_->doImport(x, *mesh_->complex_importer(), Tpetra::INSERT);
+    y_overlap_->putScalar(0.0);
+    xo = x_overlap_;
+    yo = y_overlap_;
+  } else {
+    // y = alpha * K x + beta * y, so scale y first and add alpha * K x.
+    if (beta == 0.0) {
+      y.putScalar(0.0);
+    } else if (beta != 1.0) {
+      y.scale(beta);
+    }
+    yo = Teuchos::rcpFromRef(y);
+  }
+
+  const auto & idx = mesh_->edge_lids_complex;
+  for (size_t j = 0; j < x.getNumVectors(); j++) {
+    const auto x_data = xo->getData(j);
+    auto y_data = yo->getDataNonConst(j);
+    for (size_t k = 0; k < edge_values_.size(); k++) {
+      // The 4x4 block
+      //
+      //     [ v2,   0,  v0,  v1 ]
+      //     [  0,  v2, -v1,  v0 ]
+      //     [ v0, -v1,  v2,   0 ]
+      //     [ v1,  v0,   0,  v2 ]
+      //
+      // at the real and imaginary parts of the edge vertices.
+      const double v0 = alpha * edge_values_[k][0];
+      const double v1 = alpha * edge_values_[k][1];
+      const double v2 = alpha * edge_values_[k][2];
+      const auto & i = idx[k];
+      const double x0 = x_data[i[0]];
+      const double x1 = x_data[i[1]];
+      const double x2 = x_data[i[2]];
+      const double x3 = x_data[i[3]];
+      y_data[i[0]] += v2 * x0 + v0 * x2 + v1 * x3;
+      y_data[i[1]] += v2 * x1 - v1 * x2 + v0 * x3;
+      y_data[i[2]] += v0 * x0 - v1 * x1 + v2 * x2;
+      y_data[i[3]] += v1 * x0 + v0 * x1 + v2 * x3;
+    }
+  }
+
+  if (is_distributed_) {
+    y_export_->putScalar(0.0);
+    y_export_->doExport(*y_overlap_, *mesh_->complex_exporter(), Tpetra::ADD);
+    if (beta == 0.0) {
+      Tpetra::deep_copy(y, *y_export_);
+    } else {
+      y.update(1.0, *y_export_, beta);
+    }
+  }
+
+  return;
+}
+// =============================================================================
+}  // namespace parameter_matrix
+}  // namespace nosh
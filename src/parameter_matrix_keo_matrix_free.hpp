@@ -0,0 +1,108 @@
+#ifndef NOSH_PARAMETERMATRIX_KEOMATRIXFREE_H
+#define NOSH_PARAMETERMATRIX_KEOMATRIXFREE_H
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+#include <Teuchos_Time.hpp>
+#endif
+
+#include <Tpetra_MultiVector.hpp>
+#include <Tpetra_Operator.hpp>
+
+#include "mesh.hpp"
+#include "parameter_object.hpp"
+
+// forward declarations
+namespace nosh
+{
+namespace scalar_field
+{
+class base;
+}
+namespace vector_field
+{
+class base;
+}
+} // namespace nosh
+
+namespace nosh
+{
+namespace parameter_matrix
+{
+
+//! The kinetic energy operator of keo without assembling it. Only three
+//! values per edge are stored (instead of a 4x4 block with its column
+//! indices); the action is computed from them and the edge vertex table of
+//! the mesh.
+//! With param_name, this is the derivative with respect to that parameter,
+//! as in DkeoDP.
+class keo_matrix_free:
+  public nosh::parameter_object, public Tpetra::Operator<double,int,int>
+{
+public:
+  keo_matrix_free(
+      const std::shared_ptr<const nosh::mesh> &mesh,
+      const std::shared_ptr<const nosh::scalar_field::base> &thickness,
+      const std::shared_ptr<nosh::vector_field::base> &mvp,
+      const std::string & param_name = ""
+      );
+
+  ~keo_matrix_free() override;
+
+  //! Gets the initial parameters from this module.
+  std::map<std::string, double>
+  get_scalar_parameters() const override;
+
+  void
+  apply(
+      const Tpetra::MultiVector<double,int,int> & x,
+      Tpetra::MultiVector<double,int,int> & y,
+      Teuchos::ETransp mode = Teuchos::NO_TRANS,
+      double alpha = Teuchos::ScalarTraits<double>::one(),
+      double beta = Teuchos::ScalarTraits<double>::zero()
+      ) const override;
+
+  Teuchos::RCP<const Tpetra::Map<int,int>>
+  getDomainMap() const override;
+
+  Teuchos::RCP<const Tpetra::Map<int,int>>
+  getRangeMap() const override;
+
+protected:
+private:
+  void
+  refill_(
+      const std::map<std::string, double> & scalar_params,
+      const std::map<std::string, std::shared_ptr<const Tpetra::Vector<double, int, int>>> & vector_params
+      ) override;
+
+private:
+  const std::shared_ptr<const nosh::mesh> mesh_;
+#ifdef NOSH_TEUCHOS_TIME_MONITOR
+  const Teuchos::RCP<Teuchos::Time> keo_fill_time_;
+  const Teuchos::RCP<Teuchos::Time> keo_apply_time_;
+#endif
+  const std::shared_ptr<const nosh::scalar_field::base> thickness_;
+  const std::shared_ptr<nosh::vector_field::base> mvp_;
+  const std::string param_name_;
+
+  mutable std::vector<double> alpha_cache_;
+  mutable bool alpha_cache_up_to_date_;
+
+  //! v0, v1, v2 of every edge, see parameter_matrix::keo
+  std::vector<std::array<double,3>> edge_values_;
+
+  const bool is_distributed_;
+  mutable Teuchos::RCP<Tpetra::MultiVector<double,int,int>> x_overlap_;
+  mutable Teuchos::RCP<Tpetra::MultiVector<double,int,int>> y_overlap_;
+  mutable Teuchos::RCP<Tpetra::MultiVector<double,int,int>> y_export_;
+};
+} // namespace parameter_matrix
+} // namespace nosh
+
+#endif // NOSH_PARAMETERMATRIX_KEOMATRIXFREE_H
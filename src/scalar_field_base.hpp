@@ -20,6 +20,18 @@ public:
   const Tpetra::Vector<double,int,int>
   get_v(const std::map<std::string, double> & params) const = 0;
 
+  //! Like get_v(), but writes into v (with the same map as get_v()'s
+  //! result) such that callers can reuse their work vectors.
+  virtual
+  void
+  fill_v(
+      const std::map<std::string, double> & params,
+      Tpetra::Vector<double,int,int> & v
+      ) const
+  {
+    Tpetra::deep_copy(v, this->get_v(params));
+  }
+
   virtual
   const Tpetra::Vector<double,int,int>
   get_dvdp(
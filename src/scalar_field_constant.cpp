@@ -57,6 +57,21 @@ get_v(const std::map<std::string, double> & params) const
   return vals;
 }
 // ============================================================================
+void
+constant::
+fill_v(
+    const std::map<std::string, double> & params,
+    Tpetra::Vector<double,int,int> & v
+    ) const
+{
+  auto it = params.find(param1_name_);
+  if (it != params.end()) {
+    v.putScalar(c_ + it->second);
+  } else {
+    v.putScalar(c_);
+  }
+}
+// ============================================================================
 const Tpetra::Vector<double,int,int>
 constant::
 get_dvdp(
@@ -36,6 +36,12 @@ public:
   const Tpetra::Vector<double,int,int>
   get_v(const std::map<std::string, double> & params) const override;
 
+  void
+  fill_v(
+      const std::map<std::string, double> & params,
+      Tpetra::Vector<double,int,int> & v
+      ) const override;
+
   const Tpetra::Vector<double,int,int>
   get_dvdp(const std::map<std::string, double> & params,
           const std::string & param_name
@@ -40,6 +40,16 @@ get_v(const std::map<std::string, double> & params) const
   return vals;
 }
 // ============================================================================
+void
+explicit_values::
+fill_v(
+    const std::map<std::string, double> & params,
+    Tpetra::Vector<double,int,int> & v
+    ) const
+{
+  v.update(params.at("beta"), *node_values_, 0.0);
+}
+// ============================================================================
 const Tpetra::Vector<double,int,int>
 explicit_values::
 get_dvdp(const std::map<std::string, double> & params,
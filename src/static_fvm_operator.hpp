@@ -0,0 +1,299 @@
+#ifndef NOSH_STATIC_FVM_OPERATOR_H
+#define NOSH_STATIC_FVM_OPERATOR_H
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "fvm_operator.hpp"
+
+namespace nosh
+{
+  //! fvm_operator with the core types known at compile time, e.g., for the
+  //! code generated by nfc. The cores are evaluated without virtual calls
+  //! such that the compiler can inline them, and if all edge cores share their
+  //! subdomains, the edge loops are fused into one.
+  //!
+  //! The parameters are std::tuple<...> of the edge, vertex, and boundary core
+  //! types.
+  template<typename EdgeCores, typename VertexCores, typename BoundaryCores>
+  class static_fvm_operator;
+
+  template<typename... E, typename... V, typename... B>
+  class static_fvm_operator<std::tuple<E...>, std::tuple<V...>, std::tuple<B...>>:
+    public fvm_operator
+  {
+    private:
+      // Compile-time loops over the cores: The overloads for index I handle
+      // core I and recurse to I+1; the ones for the tuple size end the
+      // recursion.
+      template<size_t I>
+      using core_index = std::integral_constant<size_t, I>;
+
+    public:
+      static_fvm_operator(
+        const std::shared_ptr<const nosh::mesh> & _mesh,
+        const std::tuple<std::shared_ptr<E>...> & edge_cores,
+        const std::tuple<std::shared_ptr<V>...> & vertex_cores,
+        const std::tuple<std::shared_ptr<B>...> & boundary_cores,
+        std::vector<std::shared_ptr<operator_core_dirichlet>> dirichlets,
+        std::vector<std::shared_ptr<Tpetra::Operator<double,int,int>>> operators
+        ) :
+      fvm_operator(
+          _mesh,
+          to_base_vector_<operator_core_edge>(edge_cores),
+          to_base_vector_<operator_core_vertex>(vertex_cores),
+          to_base_vector_<operator_core_boundary>(boundary_cores),
+          std::move(dirichlets),
+          std::move(operators)
+          ),
+      typed_edge_cores_(edge_cores),
+      typed_vertex_cores_(vertex_cores),
+      typed_boundary_cores_(boundary_cores),
+      is_fused_(true)
+      {
+        for (const auto & core: this->edge_cores_) {
+          is_fused_ = is_fused_
+            && core->subdomain_ids == this->edge_cores_[0]->subdomain_ids;
+        }
+      }
+
+      ~static_fvm_operator() override = default;
+
+    protected:
+      void
+      apply_edge_contributions_(
+          const Teuchos::ArrayRCP<const double> & x_data,
+          const Teuchos::ArrayRCP<double> & y_data,
+          const bool interior,
+          const double alpha
+          ) const override
+      {
+        const int part = interior ? 0 : 1;
+        if (!is_fused_) {
+          this->apply_edge_core_(core_index<0>(), x_data, y_data, part, alpha);
+          return;
+        }
+
+        if (this->edge_cores_.empty()) {
+          return;
+        }
+        for (const auto & subdomain_id: this->edge_cores_[0]->subdomain_ids) {
+          const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+          const auto & edge_table = tables.edge_table;
+          const auto & half_edge_table = tables.half_edge_table;
+          this->for_each_split_edge_(
+              tables, this->edge_splits_.at(subdomain_id), part,
+              // edges inside the subdomain
+              [&](const int k) {
+                double val0 = 0.0;
+                double val1 = 0.0;
+                this->eval_edge_(
+                    core_index<0>(), tables.edges[k], x_data, val0, val1
+                    );
+                y_data[edge_table[k][1]] += alpha * val0;
+                y_data[edge_table[k][2]] += alpha * val1;
+              },
+              // boundary edges; only the inside vertex gets a contribution
+              [&](const int k) {
+                double val0 = 0.0;
+                double val1 = 0.0;
+                this->eval_edge_(
+                    core_index<0>(), tables.half_edges[k], x_data, val0, val1
+                    );
+                y_data[half_edge_table[k][1]] +=
+                  alpha * ((half_edge_table[k][2] == 0) ? val0 : val1);
+              });
+        }
+      }
+
+      void
+      apply_vertex_contributions_(
+          const Teuchos::ArrayRCP<const double> & x_data,
+          const Teuchos::ArrayRCP<double> & y_data,
+          const double alpha
+          ) const override
+      {
+        this->apply_vertex_core_(
+            typed_vertex_cores_, core_index<0>(), x_data, y_data, alpha
+            );
+      }
+
+      void
+      apply_domain_boundary_contributions_(
+          const Teuchos::ArrayRCP<const double> & x_data,
+          const Teuchos::ArrayRCP<double> & y_data,
+          const double alpha
+          ) const override
+      {
+        this->apply_vertex_core_(
+            typed_boundary_cores_, core_index<0>(), x_data, y_data, alpha
+            );
+      }
+
+    private:
+      //! The cores as pointers to their base class, for fvm_operator.
+      template<typename Base, typename Cores>
+      static
+      std::vector<std::shared_ptr<Base>>
+      to_base_vector_(const Cores & cores)
+      {
+        std::vector<std::shared_ptr<Base>> out;
+        append_cores_(out, cores, core_index<0>());
+        return out;
+      }
+
+      template<typename Base, typename Cores, size_t I>
+      static
+      void
+      append_cores_(
+          std::vector<std::shared_ptr<Base>> & out,
+          const Cores & cores,
+          core_index<I>,
+          typename std::enable_if<(I < std::tuple_size<Cores>::value)>::type * = nullptr
+          )
+      {
+        out.push_back(std::get<I>(cores));
+        append_cores_(out, cores, core_index<I+1>());
+      }
+
+      template<typename Base, typename Cores, size_t I>
+      static
+      void
+      append_cores_(
+          std::vector<std::shared_ptr<Base>> &,
+          const Cores &,
+          core_index<I>,
+          typename std::enable_if<(I == std::tuple_size<Cores>::value)>::type * = nullptr
+          )
+      {
+      }
+
+      //! Adds the values of all edge cores at edge to val0, val1.
+      template<size_t I>
+      void
+      eval_edge_(
+          core_index<I>,
+          const moab::EntityHandle & edge,
+          const Teuchos::ArrayRCP<const double> & x_data,
+          double & val0,
+          double & val1
+          ) const
+      {
+        typedef typename std::tuple_element<I, std::tuple<E...>>::type core_type;
+        // qualified, i.e., non-virtual call
+        const auto vals =
+          std::get<I>(typed_edge_cores_)->core_type::eval(edge, x_data);
+        val0 += std::get<0>(vals);
+        val1 += std::get<1>(vals);
+        this->eval_edge_(core_index<I+1>(), edge, x_data, val0, val1);
+      }
+
+      void
+      eval_edge_(
+          core_index<sizeof...(E)>,
+          const moab::EntityHandle &,
+          const Teuchos::ArrayRCP<const double> &,
+          double &,
+          double &
+          ) const
+      {
+      }
+
+      //! Unfused edge loops, one core after the other.
+      template<size_t I>
+      void
+      apply_edge_core_(
+          core_index<I>,
+          const Teuchos::ArrayRCP<const double> & x_data,
+          const Teuchos::ArrayRCP<double> & y_data,
+          const int part,
+          const double alpha
+          ) const
+      {
+        typedef typename std::tuple_element<I, std::tuple<E...>>::type core_type;
+        const core_type & core = *std::get<I>(typed_edge_cores_);
+        for (const auto & subdomain_id: core.subdomain_ids) {
+          const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+          const auto & edge_table = tables.edge_table;
+          const auto & half_edge_table = tables.half_edge_table;
+          this->for_each_split_edge_(
+              tables, this->edge_splits_.at(subdomain_id), part,
+              [&](const int k) {
+                const auto vals = core.core_type::eval(tables.edges[k], x_data);
+                y_data[edge_table[k][1]] += alpha * std::get<0>(vals);
+                y_data[edge_table[k][2]] += alpha * std::get<1>(vals);
+              },
+              [&](const int k) {
+                const auto vals =
+                  core.core_type::eval(tables.half_edges[k], x_data);
+                y_data[half_edge_table[k][1]] += alpha * (
+                    (half_edge_table[k][2] == 0) ?
+                    std::get<0>(vals) :
+                    std::get<1>(vals)
+                    );
+              });
+        }
+        this->apply_edge_core_(core_index<I+1>(), x_data, y_data, part, alpha);
+      }
+
+      void
+      apply_edge_core_(
+          core_index<sizeof...(E)>,
+          const Teuchos::ArrayRCP<const double> &,
+          const Teuchos::ArrayRCP<double> &,
+          const int,
+          const double
+          ) const
+      {
+      }
+
+      //! Vertex (or boundary) core I on the owned vertices of its subdomains.
+      template<typename Cores, size_t I>
+      void
+      apply_vertex_core_(
+          const Cores & cores,
+          core_index<I>,
+          const Teuchos::ArrayRCP<const double> & x_data,
+          const Teuchos::ArrayRCP<double> & y_data,
+          const double alpha,
+          typename std::enable_if<(I < std::tuple_size<Cores>::value)>::type * = nullptr
+          ) const
+      {
+        typedef typename std::tuple_element<I, Cores>::type::element_type core_type;
+        const core_type & core = *std::get<I>(cores);
+        for (const auto & subdomain_id: core.subdomain_ids) {
+          const auto & tables = this->mesh->get_subdomain_tables(subdomain_id);
+          this->for_each_owned_vertex_(subdomain_id, [&](const int, const int k) {
+            y_data[tables.vertex_lids[k]] +=
+              alpha * core.core_type::eval(tables.vertices[k], x_data);
+          });
+        }
+        this->apply_vertex_core_(
+            cores, core_index<I+1>(), x_data, y_data, alpha
+            );
+      }
+
+      template<typename Cores, size_t I>
+      void
+      apply_vertex_core_(
+          const Cores &,
+          core_index<I>,
+          const Teuchos::ArrayRCP<const double> &,
+          const Teuchos::ArrayRCP<double> &,
+          const double,
+          typename std::enable_if<(I == std::tuple_size<Cores>::value)>::type * = nullptr
+          ) const
+      {
+      }
+
+    private:
+      const std::tuple<std::shared_ptr<E>...> typed_edge_cores_;
+      const std::tuple<std::shared_ptr<V>...> typed_vertex_cores_;
+      const std::tuple<std::shared_ptr<B>...> typed_boundary_cores_;
+      bool is_fused_;
+  };
+} // namespace nosh
+
+#endif // NOSH_STATIC_FVM_OPERATOR_H
@@ -20,6 +20,23 @@ namespace nosh {
       virtual bool
       is_inside(const Eigen::Vector3d & x) const = 0;
 
+      //! Batched is_inside() for the n points (x[k], y[k], z[k]); sets
+      //! inside[k] to 1 or 0. mesh::mark_subdomains() calls this concurrently
+      //! on disjoint chunks of points.
+      virtual void
+      is_inside_batch(
+          const double * x,
+          const double * y,
+          const double * z,
+          const int n,
+          char * inside
+          ) const
+      {
+        for (int k = 0; k < n; k++) {
+          inside[k] = this->is_inside(Eigen::Vector3d(x[k], y[k], z[k]));
+        }
+      }
+
     public:
       const std::string id;
       const bool is_boundary_only;
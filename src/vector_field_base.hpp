@@ -3,6 +3,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include <Eigen/Dense>
 
@@ -30,6 +31,17 @@ public:
   double
   get_edge_projection(const unsigned int edge_index) const = 0;
 
+  //! The projections onto the edges 0, ..., projections.size()-1 in one
+  //! call.
+  virtual
+  void
+  get_edge_projections(std::vector<double> & projections) const
+  {
+    for (size_t k = 0; k < projections.size(); k++) {
+      projections[k] = this->get_edge_projection(k);
+    }
+  }
+
   virtual
   double
   get_d_edge_projection_dp(
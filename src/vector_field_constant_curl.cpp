@@ -103,6 +103,28 @@ get_edge_projection(const unsigned int edge_index) const
   return mu_ * rotatedBCache_.dot(edgeCache_[edge_index]);
 }
 // ============================================================================
+void
+constantCurl::
+get_edge_projections(std::vector<double> & projections) const
+{
+  // Update caches.
+  if (!edgeCacheUptodate_) {
+    this->initializeEdgeCache_();
+  }
+
+  if (rotatedBCacheAngle_ != theta_) {
+    rotatedBCache_ = *b_;
+    this->rotate_(rotatedBCache_, *u_, theta_);
+    rotatedBCacheAngle_ = theta_;
+  }
+
+  const Eigen::Vector3d rb = mu_ * rotatedBCache_;
+  for (size_t k = 0; k < projections.size(); k++) {
+    projections[k] = rb.dot(edgeCache_[k]);
+  }
+  return;
+}
+// ============================================================================
 double
 constantCurl::
 get_d_edge_projection_dp(
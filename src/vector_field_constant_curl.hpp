@@ -33,6 +33,9 @@ public:
   double
   get_edge_projection(const unsigned int edge_index) const override;
 
+  void
+  get_edge_projections(std::vector<double> & projections) const override;
+
   double
   get_d_edge_projection_dp(
       const unsigned int edge_index,
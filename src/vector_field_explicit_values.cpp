@@ -17,23 +17,19 @@ explicit_values(
     const double mu
     ) :
   mu_(mu),
-  edgeProjectionCache_(mesh.my_edges().size())
+  edgeProjectionCache_(mesh.edge_lids.size())
 {
   // Initialize the cache.
-  const std::vector<edge> edges = mesh.my_edges();
-
   // TODO(nschloe): make mb_ private again
   moab::Range verts = mesh.mbw_->get_entities_by_dimension(0, 0);
 
   const auto data = mesh.get_data(field_name, verts);
+  const auto & x = mesh.vertex_coords();
 
   // Loop over all edges and create the cache.
-  for (std::size_t k = 0; k < edges.size(); k++) {
-    const auto v0 = std::get<0>(edges[k]);
-    const auto v1 = std::get<1>(edges[k]);
-
-    const auto idx0 = mesh.local_index(v0);
-    const auto idx1 = mesh.local_index(v1);
+  for (std::size_t k = 0; k < mesh.edge_lids.size(); k++) {
+    const auto idx0 = mesh.edge_lids[k][0];
+    const auto idx1 = mesh.edge_lids[k][1];
 
     Eigen::Vector3d A0(data[3*idx0], data[3*idx0 + 1], data[3*idx0 + 2]);
     Eigen::Vector3d A1(data[3*idx1], data[3*idx1 + 1], data[3*idx1 + 2]);
@@ -42,7 +38,11 @@ explicit_values(
     // values at the adjacent vertices.
     Eigen::Vector3d av = 0.5 * (A0 + A1);
 
-    const auto edge_coords = mesh.get_coords(v0) - mesh.get_coords(v1);
+    const Eigen::Vector3d edge_coords(
+        x.x[idx0] - x.x[idx1],
+        x.y[idx0] - x.y[idx1],
+        x.z[idx0] - x.z[idx1]
+        );
 
     edgeProjectionCache_[k] = av.dot(edge_coords);
   }
@@ -75,6 +75,16 @@ get_edge_projection(const unsigned int edge_index) const
   return mu_ * edgeProjectionCache_[edge_index];
 }
 // ============================================================================
+void
+explicit_values::
+get_edge_projections(std::vector<double> & projections) const
+{
+  for (size_t k = 0; k < projections.size(); k++) {
+    projections[k] = mu_ * edgeProjectionCache_[k];
+  }
+  return;
+}
+// ============================================================================
 double
 explicit_values::
 get_d_edge_projection_dp(
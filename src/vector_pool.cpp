@@ -0,0 +1,142 @@
+#include "vector_pool.hpp"
+
+#include <mpi.h>
+
+#ifdef NOSH_KOKKOS
+#include <Kokkos_Core.hpp>
+#endif
+#include <Teuchos_TestForException.hpp>
+
+namespace
+{
+// MPI calls the delete functions of the attributes of MPI_COMM_SELF at the
+// beginning of MPI_Finalize, while MPI is still usable.
+int
+clear_pool(MPI_Comm comm, int keyval, void * attribute, void * pool)
+{
+  (void) comm;
+  (void) keyval;
+  (void) attribute;
+  static_cast<nosh::vector_pool*>(pool)->clear();
+  return MPI_SUCCESS;
+}
+} // anonymous namespace
+
+namespace nosh
+{
+// =============================================================================
+vector_pool::
+vector_pool() :
+  state_(std::make_shared<state>())
+{
+  state_->num_allocations = 0;
+  state_->num_reuses = 0;
+}
+// =============================================================================
+template<typename V, typename F>
+std::shared_ptr<V>
+vector_pool::
+borrow_(
+    std::map<key, std::vector<std::unique_ptr<V>>> state::* free_lists,
+    const key & k,
+    const F & create
+    )
+{
+  auto & free = ((*state_).*free_lists)[k];
+  std::unique_ptr<V> v;
+  if (free.empty()) {
+    v.reset(create());
+    state_->num_allocations++;
+  } else {
+    v = std::move(free.back());
+    free.pop_back();
+    state_->num_reuses++;
+  }
+
+  // Return the vector to the pool on release, or free it if the pool is gone.
+  const std::weak_ptr<state> pool = state_;
+  return std::shared_ptr<V>(v.release(), [pool, free_lists, k](V * ptr) {
+    const auto s = pool.lock();
+    if (s) {
+      ((*s).*free_lists)[k].emplace_back(ptr);
+    } else {
+      delete ptr;
+    }
+  });
+}
+// =============================================================================
+std::shared_ptr<Tpetra::Vector<double,int,int>>
+vector_pool::
+get(const Teuchos::RCP<const Tpetra::Map<int,int>> & map)
+{
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(map.is_null(), "Map is null.");
+  return this->borrow_(
+      &state::vectors,
+      key(map.get(), 1),
+      [&]() {
+        return new Tpetra::Vector<double,int,int>(map, false);
+      });
+}
+// =============================================================================
+std::shared_ptr<Tpetra::MultiVector<double,int,int>>
+vector_pool::
+get(
+    const Teuchos::RCP<const Tpetra::Map<int,int>> & map,
+    const std::size_t num_vectors
+    )
+{
+  TEUCHOS_TEST_FOR_EXCEPT_MSG(map.is_null(), "Map is null.");
+  return this->borrow_(
+      &state::multi_vectors,
+      key(map.get(), num_vectors),
+      [&]() {
+        return new Tpetra::MultiVector<double,int,int>(map, num_vectors, false);
+      });
+}
+// =============================================================================
+void
+vector_pool::
+reset_counters()
+{
+  state_->num_allocations = 0;
+  state_->num_reuses = 0;
+}
+// =============================================================================
+void
+vector_pool::
+clear()
+{
+  state_->vectors.clear();
+  state_->multi_vectors.clear();
+}
+// =============================================================================
+vector_pool &
+vector_pool::
+global()
+{
+  static vector_pool pool;
+  // The pooled vectors hold maps and their communicators, which must go
+  // before MPI and Kokkos are finalized, not at static destruction.
+  static const bool finalize_hooks = [&]() {
+    int initialized = 0;
+    int finalized = 0;
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+    if (!initialized || finalized) {
+      return false;
+    }
+    int keyval;
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, clear_pool, &keyval, &pool);
+    MPI_Comm_set_attr(MPI_COMM_SELF, keyval, nullptr);
+#ifdef NOSH_KOKKOS
+    Kokkos::push_finalize_hook([]() {
+      vector_pool::global().clear();
+    });
+#endif
+    return true;
+  }();
+  (void) finalize_hooks;
+  return pool;
+}
+// =============================================================================
+} // namespace nosh
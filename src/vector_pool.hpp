@@ -0,0 +1,96 @@
+#ifndef NOSH_VECTORPOOL_H
+#define NOSH_VECTORPOOL_H
+// =============================================================================
+// includes
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Teuchos_RCP.hpp>
+#include <Tpetra_Map.hpp>
+#include <Tpetra_MultiVector.hpp>
+#include <Tpetra_Vector.hpp>
+
+namespace nosh
+{
+//! Pool of work vectors for temporaries on the hot paths (operator applies,
+//! model evaluations). Vectors are keyed by their map and number of columns.
+//! A borrowed vector goes back to the pool when the last copy of its pointer
+//! is released; its values are undefined when it is handed out.
+//!
+//! The pool isn't thread-safe.
+class vector_pool
+{
+public:
+  vector_pool();
+
+  vector_pool(const vector_pool &) = delete;
+  vector_pool & operator=(const vector_pool &) = delete;
+
+  std::shared_ptr<Tpetra::Vector<double,int,int>>
+  get(const Teuchos::RCP<const Tpetra::Map<int,int>> & map);
+
+  std::shared_ptr<Tpetra::MultiVector<double,int,int>>
+  get(
+      const Teuchos::RCP<const Tpetra::Map<int,int>> & map,
+      const std::size_t num_vectors
+      );
+
+  //! Number of vectors created since the last reset_counters().
+  std::size_t
+  num_allocations() const
+  {
+    return state_->num_allocations;
+  }
+
+  //! Number of vectors handed out again, i.e., allocations avoided, since
+  //! the last reset_counters().
+  std::size_t
+  num_reuses() const
+  {
+    return state_->num_reuses;
+  }
+
+  void
+  reset_counters();
+
+  //! Frees all vectors that currently aren't borrowed.
+  void
+  clear();
+
+  //! The pool shared by all of nosh. It's cleared at the beginning of
+  //! MPI_Finalize (and by Kokkos::finalize with NOSH_KOKKOS), so its first
+  //! use must be after MPI_Init.
+  static
+  vector_pool &
+  global();
+
+private:
+  typedef std::pair<const Tpetra::Map<int,int>*, std::size_t> key;
+
+  struct state {
+    // The pooled vectors hold their maps, so the map addresses stay unique.
+    std::map<key, std::vector<std::unique_ptr<Tpetra::Vector<double,int,int>>>>
+      vectors;
+    std::map<key, std::vector<std::unique_ptr<Tpetra::MultiVector<double,int,int>>>>
+      multi_vectors;
+    std::size_t num_allocations;
+    std::size_t num_reuses;
+  };
+
+  template<typename V, typename F>
+  std::shared_ptr<V>
+  borrow_(
+      std::map<key, std::vector<std::unique_ptr<V>>> state::* free_lists,
+      const key & k,
+      const F & create
+      );
+
+private:
+  const std::shared_ptr<state> state_;
+};
+} // namespace nosh
+// =============================================================================
+#endif // NOSH_VECTORPOOL_H
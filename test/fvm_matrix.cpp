@@ -0,0 +1,184 @@
+#include <catch.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Teuchos_DefaultComm.hpp>
+
+#include <nosh.hpp>
+
+// =============================================================================
+// integrate(lambda x: -n_dot_grad(u(x)), dS)
+class laplace_core: public nosh::matrix_core_edge
+{
+  public:
+    explicit laplace_core(const std::shared_ptr<const nosh::mesh> & mesh):
+      mesh_(mesh),
+      edge_data_(mesh->get_edge_data())
+    {}
+
+    nosh::matrix_core_edge_data
+    eval(const moab::EntityHandle & edge) const override
+    {
+      const auto k = mesh_->local_index(edge);
+      const double alpha = edge_data_[k].covolume / edge_data_[k].length;
+      return {
+        {{alpha, -alpha}, {-alpha, alpha}},
+        {0.0, 0.0}
+      };
+    }
+
+  private:
+    const std::shared_ptr<const nosh::mesh> mesh_;
+    const std::vector<nosh::mesh::edge_data> edge_data_;
+};
+// =============================================================================
+// integrate(lambda x: 1.0, dV)
+class source_core: public nosh::matrix_core_vertex
+{
+  public:
+    explicit source_core(const std::shared_ptr<const nosh::mesh> & mesh):
+      mesh_(mesh),
+      control_volumes_()
+    {
+      Tpetra::Vector<double,int,int> cv(Teuchos::rcp(mesh->overlap_map()));
+      cv.doImport(*mesh->control_volumes(), *mesh->importer(), Tpetra::INSERT);
+      const auto data = cv.getData();
+      control_volumes_.assign(data.begin(), data.end());
+    }
+
+    nosh::vertex_data
+    eval(const moab::EntityHandle & vertex) const override
+    {
+      const auto k = mesh_->local_index(vertex);
+      return {0.0, control_volumes_[k]};
+    }
+
+  private:
+    const std::shared_ptr<const nosh::mesh> mesh_;
+    std::vector<double> control_volumes_;
+};
+// =============================================================================
+// u = 1 + x + 2y on the boundary
+class bc_core: public nosh::matrix_core_dirichlet
+{
+  public:
+    explicit bc_core(const std::shared_ptr<const nosh::mesh> & mesh):
+      matrix_core_dirichlet({"boundary"}),
+      mesh_(mesh)
+    {}
+
+    double
+    eval(const moab::EntityHandle & vertex) const override
+    {
+      const auto x = mesh_->get_coords(vertex);
+      return 1.0 + x[0] + 2 * x[1];
+    }
+
+  private:
+    const std::shared_ptr<const nosh::mesh> mesh_;
+};
+// =============================================================================
+std::shared_ptr<nosh::fvm_matrix>
+create_matrix(
+    const std::shared_ptr<const nosh::mesh> & mesh,
+    const std::shared_ptr<const nosh::matrix_core_dirichlet> & bc,
+    const bool symmetric_dbcs
+    )
+{
+  return std::make_shared<nosh::fvm_matrix>(
+      mesh,
+      std::vector<std::shared_ptr<const nosh::matrix_core_edge>>{
+        std::make_shared<laplace_core>(mesh)
+      },
+      std::vector<std::shared_ptr<const nosh::matrix_core_vertex>>{
+        std::make_shared<source_core>(mesh)
+      },
+      std::vector<std::shared_ptr<const nosh::matrix_core_boundary>>{},
+      std::vector<std::shared_ptr<const nosh::matrix_core_dirichlet>>{bc},
+      symmetric_dbcs
+      );
+}
+// =============================================================================
+void
+testSymmetricDirichlet(const std::string & input_filename_base)
+{
+  auto comm =  Teuchos::DefaultComm<int>::getComm();
+  const int size = comm->getSize();
+  const std::string input_filename = (size == 1) ?
+    "data/" + input_filename_base + ".h5m" :
+    "data/" + input_filename_base + "-" + std::to_string(size) + ".h5m"
+    ;
+  auto mesh = nosh::read(input_filename);
+
+  const auto bc = std::make_shared<bc_core>(mesh);
+
+  auto A = create_matrix(mesh, bc, false);
+  const auto map = A->getDomainMap();
+  auto b = std::make_shared<Tpetra::Vector<double,int,int>>(map);
+  A->fill(b);
+
+  auto A_sym = create_matrix(mesh, bc, true);
+  auto b_sym = std::make_shared<Tpetra::Vector<double,int,int>>(map);
+  A_sym->fill(b_sym);
+
+  // (A_sym u, v) == (u, A_sym v)
+  Tpetra::Vector<double,int,int> u(map);
+  u.randomize();
+  Tpetra::Vector<double,int,int> v(map);
+  v.randomize();
+  Tpetra::Vector<double,int,int> Au(map);
+  A_sym->apply(u, Au);
+  Tpetra::Vector<double,int,int> Av(map);
+  A_sym->apply(v, Av);
+  REQUIRE(v.dot(Au) == Approx(u.dot(Av)).epsilon(1.0e-12));
+
+  // Both systems have the same solution: Any x with the boundary values gives
+  // the same residual. (The Dirichlet rows are satisfied by x in both.)
+  Tpetra::Vector<double,int,int> x(map);
+  x.randomize();
+  {
+    auto x_data = x.getDataNonConst();
+    const auto overlap_map = mesh->overlap_map();
+    for (const auto & vertex: mesh->boundary_vertices) {
+      const int gid = overlap_map->getGlobalElement(mesh->local_index(vertex));
+      const int lid = map->getLocalElement(gid);
+      // only on the owner
+      if (lid != Teuchos::OrdinalTraits<int>::invalid()) {
+        x_data[lid] = bc->eval(vertex);
+      }
+    }
+  }
+  Tpetra::Vector<double,int,int> r(map);
+  A->apply(x, r);
+  r.update(-1.0, *b, 1.0);
+  Tpetra::Vector<double,int,int> r_sym(map);
+  A_sym->apply(x, r_sym);
+  r_sym.update(-1.0, *b_sym, 1.0);
+
+  Tpetra::Vector<double,int,int> diff(map);
+  diff.update(1.0, r_sym, -1.0, r, 0.0);
+  REQUIRE(diff.norm2() < 1.0e-12 * r.norm2());
+
+  // refill() gives the same values
+  A_sym->refill(b_sym);
+  Tpetra::Vector<double,int,int> r_refill(map);
+  A_sym->apply(x, r_refill);
+  r_refill.update(-1.0, *b_sym, 1.0);
+  diff.update(1.0, r_refill, -1.0, r_sym, 0.0);
+  REQUIRE(diff.norm2() < 1.0e-12 * r.norm2());
+
+  return;
+}
+// =============================================================================
+TEST_CASE("symmetric Dirichlet conditions, pacman", "[pacman]")
+{
+  testSymmetricDirichlet("pacman");
+}
+// =============================================================================
+TEST_CASE("symmetric Dirichlet conditions, brick", "[brick]")
+{
+  testSymmetricDirichlet("brick-w-hole");
+}
+// =============================================================================
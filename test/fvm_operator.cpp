@@ -0,0 +1,641 @@
+#include <catch.hpp>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <Teuchos_DefaultComm.hpp>
+
+#include <nosh.hpp>
+
+// =============================================================================
+// integrate(lambda x: -n_dot_grad(u(x)), dS)
+class laplace_core: public nosh::operator_core_edge
+{
+  public:
+    explicit laplace_core(
+        const std::shared_ptr<const nosh::mesh> & mesh,
+        const std::set<std::string> & subdomain_ids = {"everywhere"}
+        ):
+      operator_core_edge(subdomain_ids),
+      mesh_(mesh),
+      edge_data_(mesh->get_edge_data())
+    {}
+
+    std::tuple<double,double>
+    eval(
+        const moab::EntityHandle & edge,
+        const Teuchos::ArrayRCP<const double> & u
+        ) const override
+    {
+      const auto k = mesh_->local_index(edge);
+      const auto & lids = mesh_->edge_lids[k];
+      const double alpha = edge_data_[k].covolume / edge_data_[k].length;
+      const double val = alpha * (u[lids[0]] - u[lids[1]]);
+      return std::make_tuple(val, -val);
+    }
+
+    bool
+    has_eval_multi() const override
+    {
+      return true;
+    }
+
+    void
+    eval_multi(
+        const moab::EntityHandle & edge,
+        const double * u,
+        const int num_vectors,
+        double * vals0,
+        double * vals1
+        ) const override
+    {
+      const auto k = mesh_->local_index(edge);
+      const auto & lids = mesh_->edge_lids[k];
+      const double alpha = edge_data_[k].covolume / edge_data_[k].length;
+      const double * u0 = &u[num_vectors * lids[0]];
+      const double * u1 = &u[num_vectors * lids[1]];
+      for (int j = 0; j < num_vectors; j++) {
+        vals0[j] = alpha * (u0[j] - u1[j]);
+        vals1[j] = -vals0[j];
+      }
+    }
+
+  private:
+    const std::shared_ptr<const nosh::mesh> mesh_;
+    const std::vector<nosh::mesh::edge_data> edge_data_;
+};
+// =============================================================================
+// integrate(lambda x: u(x), dV)
+class mass_core: public nosh::operator_core_vertex
+{
+  public:
+    explicit mass_core(
+        const std::shared_ptr<const nosh::mesh> & mesh,
+        const std::set<std::string> & subdomain_ids = {"everywhere"}
+        ):
+      operator_core_vertex(subdomain_ids),
+      mesh_(mesh),
+      control_volumes_()
+    {
+      Tpetra::Vector<double,int,int> cv(Teuchos::rcp(mesh->overlap_map()));
+      cv.doImport(*mesh->control_volumes(), *mesh->importer(), Tpetra::INSERT);
+      const auto data = cv.getData();
+      control_volumes_.assign(data.begin(), data.end());
+    }
+
+    double
+    eval(
+        const moab::EntityHandle & vertex,
+        const Teuchos::ArrayRCP<const double> & u
+        ) const override
+    {
+      const auto k = mesh_->local_index(vertex);
+      return control_volumes_[k] * u[k];
+    }
+
+    bool
+    has_eval_multi() const override
+    {
+      return true;
+    }
+
+    void
+    eval_multi(
+        const moab::EntityHandle & vertex,
+        const double * u,
+        const int num_vectors,
+        double * vals
+        ) const override
+    {
+      const auto k = mesh_->local_index(vertex);
+      for (int j = 0; j < num_vectors; j++) {
+        vals[j] = control_volumes_[k] * u[num_vectors * k + j];
+      }
+    }
+
+  private:
+    const std::shared_ptr<const nosh::mesh> mesh_;
+    std::vector<double> control_volumes_;
+};
+// =============================================================================
+// a subdomain with all vertices, i.e., the same as "everywhere"
+class all_subdomain: public nosh::subdomain
+{
+  public:
+    all_subdomain():
+      subdomain("all", false)
+    {}
+
+    bool
+    is_inside(const Eigen::Vector3d &) const override
+    {
+      return true;
+    }
+};
+// =============================================================================
+// the vertices with x[0] < x0
+class left_subdomain: public nosh::subdomain
+{
+  public:
+    explicit left_subdomain(const double x0):
+      subdomain("left", false),
+      x0_(x0)
+    {}
+
+    bool
+    is_inside(const Eigen::Vector3d & x) const override
+    {
+      return x[0] < x0_;
+    }
+
+  private:
+    const double x0_;
+};
+// =============================================================================
+std::shared_ptr<nosh::mesh>
+read_mesh(const std::string & input_filename_base)
+{
+  auto comm =  Teuchos::DefaultComm<int>::getComm();
+  const int size = comm->getSize();
+  const std::string input_filename = (size == 1) ?
+    "data/" + input_filename_base + ".h5m" :
+    "data/" + input_filename_base + "-" + std::to_string(size) + ".h5m"
+    ;
+  return nosh::read(input_filename);
+}
+// =============================================================================
+// || a - b || relative to || b ||
+double
+relative_difference(
+    const Tpetra::Vector<double,int,int> & a,
+    const Tpetra::Vector<double,int,int> & b
+    )
+{
+  Tpetra::Vector<double,int,int> diff(a.getMap());
+  diff.update(1.0, a, -1.0, b, 0.0);
+  return diff.norm2() / b.norm2();
+}
+// =============================================================================
+std::shared_ptr<nosh::fvm_operator>
+create_laplace(
+    const std::shared_ptr<const nosh::mesh> & mesh,
+    const std::set<std::string> & subdomain_ids = {"everywhere"}
+    )
+{
+  return std::make_shared<nosh::fvm_operator>(
+      mesh,
+      std::vector<std::shared_ptr<nosh::operator_core_edge>>{
+        std::make_shared<laplace_core>(mesh, subdomain_ids)
+      },
+      std::vector<std::shared_ptr<nosh::operator_core_vertex>>{},
+      std::vector<std::shared_ptr<nosh::operator_core_boundary>>{},
+      std::vector<std::shared_ptr<nosh::operator_core_dirichlet>>{},
+      std::vector<std::shared_ptr<Tpetra::Operator<double,int,int>>>{}
+      );
+}
+// =============================================================================
+std::shared_ptr<nosh::fvm_operator>
+create_mass(
+    const std::shared_ptr<const nosh::mesh> & mesh,
+    const std::set<std::string> & subdomain_ids = {"everywhere"}
+    )
+{
+  return std::make_shared<nosh::fvm_operator>(
+      mesh,
+      std::vector<std::shared_ptr<nosh::operator_core_edge>>{},
+      std::vector<std::shared_ptr<nosh::operator_core_vertex>>{
+        std::make_shared<mass_core>(mesh, subdomain_ids)
+      },
+      std::vector<std::shared_ptr<nosh::operator_core_boundary>>{},
+      std::vector<std::shared_ptr<nosh::operator_core_dirichlet>>{},
+      std::vector<std::shared_ptr<Tpetra::Operator<double,int,int>>>{}
+      );
+}
+// =============================================================================
+// laplace + mass, the latter as a wrapped operator
+std::shared_ptr<nosh::fvm_operator>
+create_helmholtz(
+    const std::shared_ptr<const nosh::mesh> & mesh,
+    const std::shared_ptr<Tpetra::Operator<double,int,int>> & mass
+    )
+{
+  return std::make_shared<nosh::fvm_operator>(
+      mesh,
+      std::vector<std::shared_ptr<nosh::operator_core_edge>>{
+        std::make_shared<laplace_core>(mesh)
+      },
+      std::vector<std::shared_ptr<nosh::operator_core_vertex>>{},
+      std::vector<std::shared_ptr<nosh::operator_core_boundary>>{},
+      std::vector<std::shared_ptr<nosh::operator_core_dirichlet>>{},
+      std::vector<std::shared_ptr<Tpetra::Operator<double,int,int>>>{mass}
+      );
+}
+// =============================================================================
+// laplace + mass, both as cores
+std::shared_ptr<nosh::fvm_operator>
+create_helmholtz_cores(const std::shared_ptr<const nosh::mesh> & mesh)
+{
+  return std::make_shared<nosh::fvm_operator>(
+      mesh,
+      std::vector<std::shared_ptr<nosh::operator_core_edge>>{
+        std::make_shared<laplace_core>(mesh)
+      },
+      std::vector<std::shared_ptr<nosh::operator_core_vertex>>{
+        std::make_shared<mass_core>(mesh)
+      },
+      std::vector<std::shared_ptr<nosh::operator_core_boundary>>{},
+      std::vector<std::shared_ptr<nosh::operator_core_dirichlet>>{},
+      std::vector<std::shared_ptr<Tpetra::Operator<double,int,int>>>{}
+      );
+}
+// =============================================================================
+void
+testWrappedOperator(const std::string & input_filename_base)
+{
+  auto mesh = read_mesh(input_filename_base);
+
+  auto laplace = create_laplace(mesh);
+  auto mass = create_mass(mesh);
+  auto helmholtz = create_helmholtz(mesh, mass);
+
+  const auto map = helmholtz->getDomainMap();
+  Tpetra::Vector<double,int,int> x(map);
+  x.randomize();
+
+  Tpetra::Vector<double,int,int> lx(map);
+  laplace->apply(x, lx);
+  Tpetra::Vector<double,int,int> mx(map);
+  mass->apply(x, mx);
+
+  Tpetra::Vector<double,int,int> expected(map);
+  expected.update(1.0, lx, 1.0, mx, 0.0);
+
+  Tpetra::Vector<double,int,int> y(map);
+  helmholtz->apply(x, y);
+  REQUIRE(relative_difference(y, expected) < 1.0e-12);
+
+  return;
+}
+// =============================================================================
+// y = alpha * A(x) + beta * y, with and without wrapped operators
+void
+testAlphaBeta(const std::string & input_filename_base)
+{
+  auto mesh = read_mesh(input_filename_base);
+
+  auto laplace = create_laplace(mesh);
+  auto mass = create_mass(mesh);
+  auto helmholtz = create_helmholtz(mesh, mass);
+
+  const auto map = helmholtz->getDomainMap();
+  Tpetra::Vector<double,int,int> x(map);
+  x.randomize();
+  Tpetra::Vector<double,int,int> y0(map);
+  y0.randomize();
+
+  Tpetra::Vector<double,int,int> lx(map);
+  laplace->apply(x, lx);
+  Tpetra::Vector<double,int,int> mx(map);
+  mass->apply(x, mx);
+
+  const double alpha = 2.0;
+  for (const double beta: {0.0, 1.0, -0.5}) {
+    // laplace only
+    Tpetra::Vector<double,int,int> expected(map);
+    expected.update(alpha, lx, beta, y0, 0.0);
+    Tpetra::Vector<double,int,int> y(y0, Teuchos::Copy);
+    laplace->apply(x, y, Teuchos::NO_TRANS, alpha, beta);
+    REQUIRE(relative_difference(y, expected) < 1.0e-12);
+
+    // laplace + wrapped mass
+    expected.update(alpha, mx, 1.0);
+    Tpetra::Vector<double,int,int> z(y0, Teuchos::Copy);
+    helmholtz->apply(x, z, Teuchos::NO_TRANS, alpha, beta);
+    REQUIRE(relative_difference(z, expected) < 1.0e-12);
+  }
+
+  return;
+}
+// =============================================================================
+// The cores implement eval_multi(), so applies to several vectors go through
+// the blocked traversal. Compare that to the applies to the single columns.
+void
+testMultiVector(const std::string & input_filename_base)
+{
+  auto mesh = read_mesh(input_filename_base);
+  auto helmholtz = create_helmholtz_cores(mesh);
+
+  const auto map = helmholtz->getDomainMap();
+  const double alpha = 2.0;
+  for (const int num_vectors: {1, 3, 8}) {
+    Tpetra::MultiVector<double,int,int> x(map, num_vectors);
+    x.randomize();
+    Tpetra::MultiVector<double,int,int> y0(map, num_vectors);
+    y0.randomize();
+    for (const double beta: {0.0, 0.5}) {
+      Tpetra::MultiVector<double,int,int> expected(y0, Teuchos::Copy);
+      for (int j = 0; j < num_vectors; j++) {
+        helmholtz->apply(
+            *x.getVector(j), *expected.getVectorNonConst(j),
+            Teuchos::NO_TRANS, alpha, beta
+            );
+      }
+
+      Tpetra::MultiVector<double,int,int> y(y0, Teuchos::Copy);
+      helmholtz->apply(x, y, Teuchos::NO_TRANS, alpha, beta);
+
+      Tpetra::MultiVector<double,int,int> diff(map, num_vectors);
+      diff.update(1.0, y, -1.0, expected, 0.0);
+      std::vector<double> diff_norms(num_vectors);
+      diff.norm2(Teuchos::arrayViewFromVector(diff_norms));
+      std::vector<double> norms(num_vectors);
+      expected.norm2(Teuchos::arrayViewFromVector(norms));
+      for (int j = 0; j < num_vectors; j++) {
+        REQUIRE(diff_norms[j] < 1.0e-12 * norms[j]);
+      }
+    }
+  }
+
+  return;
+}
+// =============================================================================
+// max |a - b| relative to max |b|
+double
+max_relative_difference(
+    const Tpetra::Vector<double,int,int> & a,
+    const Tpetra::Vector<double,int,int> & b
+    )
+{
+  Tpetra::Vector<double,int,int> diff(a.getMap());
+  diff.update(1.0, a, -1.0, b, 0.0);
+  return diff.normInf() / b.normInf();
+}
+// =============================================================================
+// static_fvm_operator gives the same as fvm_operator with the same cores. The
+// unfused loops do the same operations in the same order, so the results are
+// identical; fusing adds up the edge cores before adding to y.
+void
+testStaticOperator(const std::string & input_filename_base)
+{
+  auto mesh = read_mesh(input_filename_base);
+  const auto map = Teuchos::rcp(mesh->map());
+
+  // Split the domain at the mean x coordinate (the same on all processes).
+  Tpetra::Vector<double,int,int> coords_x(map);
+  {
+    auto data = coords_x.getDataNonConst();
+    const auto overlap_map = mesh->overlap_map();
+    const auto & coords = mesh->vertex_coords();
+    for (size_t k = 0; k < overlap_map->getNodeNumElements(); k++) {
+      const int lid = map->getLocalElement(overlap_map->getGlobalElement(k));
+      if (lid != Teuchos::OrdinalTraits<int>::invalid()) {
+        data[lid] = coords.x[k];
+      }
+    }
+  }
+  mesh->mark_subdomains({
+      std::make_shared<left_subdomain>(coords_x.meanValue())
+      });
+
+  const auto laplace = std::make_shared<laplace_core>(mesh);
+  const auto laplace_left = std::make_shared<laplace_core>(
+      mesh, std::set<std::string>{"left"}
+      );
+  const auto mass = std::make_shared<mass_core>(mesh);
+  const auto mass_left = std::make_shared<mass_core>(
+      mesh, std::set<std::string>{"left"}
+      );
+
+  Tpetra::Vector<double,int,int> x(map);
+  x.randomize();
+  const double alpha = 2.0;
+  const auto compare = [&](
+      const nosh::fvm_operator & static_op,
+      const std::vector<std::shared_ptr<nosh::operator_core_edge>> & edge_cores,
+      const std::vector<std::shared_ptr<nosh::operator_core_vertex>> & vertex_cores
+      ) {
+    const nosh::fvm_operator op(
+        mesh, edge_cores, vertex_cores, {}, {}, {}
+        );
+    Tpetra::Vector<double,int,int> expected(map);
+    op.apply(x, expected, Teuchos::NO_TRANS, alpha, 0.0);
+    Tpetra::Vector<double,int,int> y(map);
+    static_op.apply(x, y, Teuchos::NO_TRANS, alpha, 0.0);
+    return max_relative_difference(y, expected);
+  };
+
+  // one edge core, i.e., trivially fused
+  const nosh::static_fvm_operator<
+    std::tuple<laplace_core>,
+    std::tuple<mass_core>,
+    std::tuple<>
+    > op1(
+        mesh,
+        std::make_tuple(laplace),
+        std::make_tuple(mass),
+        std::tuple<>(),
+        {}, {}
+        );
+  REQUIRE(compare(op1, {laplace}, {mass}) == 0.0);
+
+  // edge cores on the same subdomains: fused
+  const nosh::static_fvm_operator<
+    std::tuple<laplace_core, laplace_core>,
+    std::tuple<mass_core, mass_core>,
+    std::tuple<>
+    > op2(
+        mesh,
+        std::make_tuple(laplace_left, laplace_left),
+        std::make_tuple(mass, mass_left),
+        std::tuple<>(),
+        {}, {}
+        );
+  REQUIRE(
+      compare(op2, {laplace_left, laplace_left}, {mass, mass_left}) < 1.0e-14
+      );
+
+  // edge cores on different subdomains: not fused
+  const nosh::static_fvm_operator<
+    std::tuple<laplace_core, laplace_core>,
+    std::tuple<mass_core>,
+    std::tuple<>
+    > op3(
+        mesh,
+        std::make_tuple(laplace, laplace_left),
+        std::make_tuple(mass_left),
+        std::tuple<>(),
+        {}, {}
+        );
+  REQUIRE(compare(op3, {laplace, laplace_left}, {mass_left}) == 0.0);
+
+  return;
+}
+// =============================================================================
+// A subdomain with all vertices gives the same operator as "everywhere", with
+// any number of processes.
+void
+testNamedSubdomain(const std::string & input_filename_base)
+{
+  auto mesh = read_mesh(input_filename_base);
+  mesh->mark_subdomains({std::make_shared<all_subdomain>()});
+
+  const auto map = Teuchos::rcp(mesh->map());
+  Tpetra::Vector<double,int,int> x(map);
+  x.randomize();
+
+  const std::vector<std::tuple<
+    std::shared_ptr<nosh::fvm_operator>,
+    std::shared_ptr<nosh::fvm_operator>
+    >> pairs = {
+      std::make_tuple(create_laplace(mesh), create_laplace(mesh, {"all"})),
+      std::make_tuple(create_mass(mesh), create_mass(mesh, {"all"}))
+    };
+  for (const auto & pair: pairs) {
+    Tpetra::Vector<double,int,int> expected(map);
+    std::get<0>(pair)->apply(x, expected);
+    Tpetra::Vector<double,int,int> y(map);
+    std::get<1>(pair)->apply(x, y);
+    REQUIRE(relative_difference(y, expected) < 1.0e-12);
+  }
+
+  return;
+}
+// =============================================================================
+// Checks the operators against properties of the continuous ones. The edge
+// coefficients make the Laplacian the P1 finite element stiffness matrix, so
+// it's exact for linear functions: L(1) = 0, L(x) = 0 at the interior
+// vertices, and x^T L(x) is the volume of the domain. The mass operator of 1
+// is the vector of control volumes. The references are the control volume
+// norms as in test/mesh.cpp; they don't depend on the number of processes.
+void
+testReferenceValues(
+    const std::string & input_filename_base,
+    const double control_vol_norm_1,
+    const double control_vol_norm_2,
+    const double control_vol_norm_inf
+    )
+{
+  auto mesh = read_mesh(input_filename_base);
+
+  auto laplace = create_laplace(mesh);
+  auto mass = create_mass(mesh);
+
+  const auto map = Teuchos::rcp(mesh->map());
+  Tpetra::Vector<double,int,int> ones(map);
+  ones.putScalar(1.0);
+
+  Tpetra::Vector<double,int,int> y(map);
+  laplace->apply(ones, y);
+  REQUIRE(y.normInf() == Approx(0.0));
+
+  mass->apply(ones, y);
+  REQUIRE(y.norm1() == Approx(control_vol_norm_1));
+  REQUIRE(y.norm2() == Approx(control_vol_norm_2));
+  REQUIRE(y.normInf() == Approx(control_vol_norm_inf));
+
+  // u = x
+  Tpetra::Vector<double,int,int> u(map);
+  const auto overlap_map = mesh->overlap_map();
+  {
+    auto u_data = u.getDataNonConst();
+    const auto & coords = mesh->vertex_coords();
+    for (size_t k = 0; k < overlap_map->getNodeNumElements(); k++) {
+      const int lid = map->getLocalElement(overlap_map->getGlobalElement(k));
+      // only on the owner
+      if (lid != Teuchos::OrdinalTraits<int>::invalid()) {
+        u_data[lid] = coords.x[k];
+      }
+    }
+  }
+  laplace->apply(u, y);
+  REQUIRE(u.dot(y) == Approx(control_vol_norm_1));
+
+  const double y_norm_inf = y.normInf();
+  {
+    auto y_data = y.getDataNonConst();
+    for (const auto & vertex: mesh->boundary_vertices) {
+      const int gid = overlap_map->getGlobalElement(mesh->local_index(vertex));
+      const int lid = map->getLocalElement(gid);
+      if (lid != Teuchos::OrdinalTraits<int>::invalid()) {
+        y_data[lid] = 0.0;
+      }
+    }
+  }
+  REQUIRE(y.normInf() < 1.0e-10 * y_norm_inf);
+
+  return;
+}
+// =============================================================================
+TEST_CASE("fvm_operator with a wrapped operator, pacman", "[pacman]")
+{
+  testWrappedOperator("pacman");
+}
+// =============================================================================
+TEST_CASE("fvm_operator with a wrapped operator, brick", "[brick]")
+{
+  testWrappedOperator("brick-w-hole");
+}
+// =============================================================================
+TEST_CASE("fvm_operator alpha and beta, pacman", "[pacman]")
+{
+  testAlphaBeta("pacman");
+}
+// =============================================================================
+TEST_CASE("fvm_operator alpha and beta, brick", "[brick]")
+{
+  testAlphaBeta("brick-w-hole");
+}
+// =============================================================================
+TEST_CASE("fvm_operator on a named subdomain, pacman", "[pacman]")
+{
+  testNamedSubdomain("pacman");
+}
+// =============================================================================
+TEST_CASE("fvm_operator on a named subdomain, brick", "[brick]")
+{
+  testNamedSubdomain("brick-w-hole");
+}
+// =============================================================================
+TEST_CASE("fvm_operator reference values, pacman", "[pacman]")
+{
+  testReferenceValues(
+      "pacman",
+      302.5227007210103,
+      15.38575790933914,
+      1.127797467043659
+      );
+}
+// =============================================================================
+TEST_CASE("fvm_operator reference values, brick", "[brick]")
+{
+  testReferenceValues(
+      "brick-w-hole",
+      388.686291694641,
+      16.6614019419857,
+      1.46847345474977
+      );
+}
+// =============================================================================
+TEST_CASE("fvm_operator on several vectors, pacman", "[pacman]")
+{
+  testMultiVector("pacman");
+}
+// =============================================================================
+TEST_CASE("fvm_operator on several vectors, brick", "[brick]")
+{
+  testMultiVector("brick-w-hole");
+}
+// =============================================================================
+TEST_CASE("static_fvm_operator, pacman", "[pacman]")
+{
+  testStaticOperator("pacman");
+}
+// =============================================================================
+TEST_CASE("static_fvm_operator, brick", "[brick]")
+{
+  testStaticOperator("brick-w-hole");
+}
+// =============================================================================
@@ -8,6 +8,7 @@
 #include <nosh.hpp>
 
 // =============================================================================
+template<typename KEO>
 void
 testKeo(
     const std::string & input_filename_base,
@@ -35,7 +36,7 @@ testKeo(
   auto mvp = std::make_shared<nosh::vector_field::explicit_values>(*mesh, "A", initMu);
   auto thickness = std::make_shared<nosh::scalar_field::constant>(*mesh, 1.0);
 
-  nosh::parameter_matrix::keo keo(mesh, thickness, mvp);
+  KEO keo(mesh, thickness, mvp);
 
   // Explicitly create the kinetic energy operator.
   keo.set_parameters({{"mu", initMu}}, {});
@@ -114,6 +115,76 @@ testKeo(
 
   return;
 }
+// =============================================================================
+// || a - b || relative to || b ||
+double
+relative_difference(
+    const Tpetra::Vector<double,int,int> & a,
+    const Tpetra::Vector<double,int,int> & b
+    )
+{
+  Tpetra::Vector<double,int,int> diff(a.getMap());
+  diff.update(1.0, a, -1.0, b, 0.0);
+  return diff.norm2() / b.norm2();
+}
+// =============================================================================
+// Compares keo_matrix_free, with alpha and beta and as the derivative with
+// respect to mu, to the assembled matrices.
+void
+testKeoMatrixFree(
+    const std::string & input_filename_base,
+    const double initMu
+    )
+{
+  auto comm =  Teuchos::DefaultComm<int>::getComm();
+  const int size = comm->getSize();
+  const std::string input_filename = (size == 1) ?
+    "data/" + input_filename_base + ".h5m" :
+    "data/" + input_filename_base + "-" + std::to_string(size) + ".h5m"
+    ;
+  auto mesh = nosh::read(input_filename);
+
+  auto mvp = std::make_shared<nosh::vector_field::explicit_values>(*mesh, "A", initMu);
+  auto thickness = std::make_shared<nosh::scalar_field::constant>(*mesh, 1.0);
+
+  nosh::parameter_matrix::keo keo(mesh, thickness, mvp);
+  keo.set_parameters({{"mu", initMu}}, {});
+  nosh::parameter_matrix::keo_matrix_free keo_mf(mesh, thickness, mvp);
+  keo_mf.set_parameters({{"mu", initMu}}, {});
+
+  const auto map = keo_mf.getDomainMap();
+  Tpetra::Vector<double,int,int> u(map);
+  u.randomize();
+  Tpetra::Vector<double,int,int> y0(map);
+  y0.randomize();
+
+  Tpetra::Vector<double,int,int> Ku(map);
+  keo.apply(u, Ku);
+
+  // y = alpha * K u + beta * y
+  const double alpha = 2.0;
+  for (const double beta: {0.0, 1.0, -0.5}) {
+    Tpetra::Vector<double,int,int> expected(map);
+    expected.update(alpha, Ku, beta, y0, 0.0);
+    Tpetra::Vector<double,int,int> y(y0, Teuchos::Copy);
+    keo_mf.apply(u, y, Teuchos::NO_TRANS, alpha, beta);
+    REQUIRE(relative_difference(y, expected) < 1.0e-12);
+  }
+
+  // dK/dmu
+  nosh::parameter_matrix::DkeoDP dkeo_dp(mesh, thickness, mvp, "mu");
+  dkeo_dp.set_parameters({{"mu", initMu}}, {});
+  nosh::parameter_matrix::keo_matrix_free dkeo_dp_mf(mesh, thickness, mvp, "mu");
+  dkeo_dp_mf.set_parameters({{"mu", initMu}}, {});
+
+  Tpetra::Vector<double,int,int> expected(map);
+  dkeo_dp.apply(u, expected);
+  Tpetra::Vector<double,int,int> y(map);
+  dkeo_dp_mf.apply(u, y);
+  REQUIRE(relative_difference(y, expected) < 1.0e-12);
+
+  return;
+}
 // ===========================================================================
 #if 0
 TEST_CASE("KEO for rectangle mesh", "[rectangle]")
@@ -129,7 +200,7 @@ TEST_CASE("KEO for rectangle mesh", "[rectangle]")
   // -0.0499844   -0.00124987  -4.99844     0.124987     0            0         5.05        0
   // 0.00124987   -0.0499844   -0.124987    -4.99844     0            0         0           5.05
   //
-  testKeo(
+  testKeo<nosh::parameter_matrix::keo>(
       "rectanglesmall",
       1.0e-2,
       10.224658806561596,
@@ -142,7 +213,7 @@ TEST_CASE("KEO for rectangle mesh", "[rectangle]")
 // ============================================================================
 TEST_CASE("KEO for pacman mesh", "[pacman]")
 {
-  testKeo(
+  testKeo<nosh::parameter_matrix::keo>(
       "pacman",
       1.0e-2,
       10.000520856079092,
@@ -155,7 +226,7 @@ TEST_CASE("KEO for pacman mesh", "[pacman]")
 #if 0
 TEST_CASE("KEO for cube mesh", "[cube]")
 {
-  testKeo(
+  testKeo<nosh::parameter_matrix::keo>(
       "cubesmall",
       1.0e-2,
       10.058364522531498,
@@ -168,7 +239,7 @@ TEST_CASE("KEO for cube mesh", "[cube]")
 // ============================================================================
 TEST_CASE("KEO for brick mesh", "[brick]")
 {
-  testKeo(
+  testKeo<nosh::parameter_matrix::keo>(
       "brick-w-hole",
       1.0e-2,
       15.131119904340618,
@@ -178,3 +249,61 @@ TEST_CASE("KEO for brick mesh", "[brick]")
       );
 }
 // ============================================================================
+TEST_CASE("Block KEO for pacman mesh", "[pacman]")
+{
+  testKeo<nosh::parameter_matrix::keo_block>(
+      "pacman",
+      1.0e-2,
+      10.000520856079092,
+      10.000520856079092,
+      0.7408852859317188, // 2 * 0.37044264296585938
+      0.37044264296585938
+      );
+}
+// ============================================================================
+TEST_CASE("Block KEO for brick mesh", "[brick]")
+{
+  testKeo<nosh::parameter_matrix::keo_block>(
+      "brick-w-hole",
+      1.0e-2,
+      15.131119904340618,
+      15.131119904340618,
+      0.3352655202584036,
+      0.16763276012920181
+      );
+}
+// ============================================================================
+TEST_CASE("Matrix-free KEO for pacman mesh", "[pacman]")
+{
+  testKeo<nosh::parameter_matrix::keo_matrix_free>(
+      "pacman",
+      1.0e-2,
+      10.000520856079092,
+      10.000520856079092,
+      0.7408852859317188, // 2 * 0.37044264296585938
+      0.37044264296585938
+      );
+}
+// ============================================================================
+TEST_CASE("Matrix-free KEO for brick mesh", "[brick]")
+{
+  testKeo<nosh::parameter_matrix::keo_matrix_free>(
+      "brick-w-hole",
+      1.0e-2,
+      15.131119904340618,
+      15.131119904340618,
+      0.3352655202584036,
+      0.16763276012920181
+      );
+}
+// ============================================================================
+TEST_CASE("Matrix-free KEO, alpha, beta, dK/dp, pacman mesh", "[pacman]")
+{
+  testKeoMatrixFree("pacman", 1.0e-2);
+}
+// ============================================================================
+TEST_CASE("Matrix-free KEO, alpha, beta, dK/dp, brick mesh", "[brick]")
+{
+  testKeoMatrixFree("brick-w-hole", 1.0e-2);
+}
+// ============================================================================
@@ -1,5 +1,6 @@
 #include <catch.hpp>
 
+#include <numeric>
 #include <string>
 
 #include <Teuchos_DefaultComm.hpp>
@@ -108,3 +109,144 @@ TEST_CASE("hashes for brick mesh", "[brick]")
       );
 }
 // ============================================================================
+void
+testMeshCache(const std::string & input_filename_base)
+{
+  const auto comm =  Teuchos::DefaultComm<int>::getComm();
+  const int size = comm->getSize();
+  const std::string input_filename = (size == 1) ?
+    "data/" + input_filename_base + ".h5m" :
+    "data/" + input_filename_base + "-" + std::to_string(size) + ".h5m"
+    ;
+
+  auto mesh = nosh::read(input_filename);
+  // The first cached read writes the cache (if not present yet), the second
+  // one takes the data from there.
+  auto cached_mesh0 = nosh::read(input_filename, true);
+  auto cached_mesh1 = nosh::read(input_filename, true);
+
+  for (const auto & cached_mesh: {cached_mesh0, cached_mesh1}) {
+    REQUIRE(cached_mesh->edge_lids.size() == mesh->edge_lids.size());
+    for (size_t k = 0; k < mesh->edge_lids.size(); k++) {
+      REQUIRE(cached_mesh->edge_lids[k][0] == mesh->edge_lids[k][0]);
+      REQUIRE(cached_mesh->edge_lids[k][1] == mesh->edge_lids[k][1]);
+      REQUIRE(cached_mesh->edge_gids[k][0] == mesh->edge_gids[k][0]);
+      REQUIRE(cached_mesh->edge_gids[k][1] == mesh->edge_gids[k][1]);
+    }
+
+    const auto edge_data = mesh->get_edge_data();
+    const auto cached_edge_data = cached_mesh->get_edge_data();
+    REQUIRE(cached_edge_data.size() == edge_data.size());
+    for (size_t k = 0; k < edge_data.size(); k++) {
+      REQUIRE(cached_edge_data[k].length == edge_data[k].length);
+      REQUIRE(cached_edge_data[k].covolume == edge_data[k].covolume);
+    }
+
+    const auto control_vols = mesh->control_volumes();
+    const auto cached_control_vols = cached_mesh->control_volumes();
+    REQUIRE(cached_control_vols->norm1() == control_vols->norm1());
+    REQUIRE(cached_control_vols->norm2() == control_vols->norm2());
+
+    REQUIRE(
+        cached_mesh->boundary_surface_areas() == mesh->boundary_surface_areas()
+        );
+    REQUIRE(
+        cached_mesh->boundary_vertices.size() == mesh->boundary_vertices.size()
+        );
+  }
+
+  return;
+}
+// ============================================================================
+TEST_CASE("cache for pacman mesh", "[pacman]")
+{
+  testMeshCache("pacman");
+}
+// ============================================================================
+TEST_CASE("cache for brick mesh", "[brick]")
+{
+  testMeshCache("brick-w-hole");
+}
+// ============================================================================
+void
+testMeshReordering(const std::string & input_filename_base)
+{
+  const auto comm =  Teuchos::DefaultComm<int>::getComm();
+  const int size = comm->getSize();
+  const std::string input_filename = (size == 1) ?
+    "data/" + input_filename_base + ".h5m" :
+    "data/" + input_filename_base + "-" + std::to_string(size) + ".h5m"
+    ;
+
+  auto mesh = nosh::read(input_filename);
+  const auto control_vols = mesh->control_volumes();
+
+  for (const std::string ordering: {"rcm", "morton"}) {
+    auto reordered_mesh = nosh::read(input_filename, false, ordering);
+
+    REQUIRE(
+        reordered_mesh->edge_lids.size() == mesh->edge_lids.size()
+        );
+    REQUIRE(
+        reordered_mesh->boundary_vertices.size()
+        == mesh->boundary_vertices.size()
+        );
+
+    // The edges are sorted by their vertices.
+    for (size_t k = 1; k < reordered_mesh->edge_lids.size(); k++) {
+      REQUIRE(
+          reordered_mesh->edge_lids[k-1][0] <= reordered_mesh->edge_lids[k][0]
+          );
+    }
+
+    // Global quantities don't depend on the ordering.
+    const auto reordered_control_vols = reordered_mesh->control_volumes();
+    REQUIRE(
+        reordered_control_vols->norm1() == Approx(control_vols->norm1())
+        );
+    REQUIRE(
+        reordered_control_vols->norm2() == Approx(control_vols->norm2())
+        );
+    const auto areas = mesh->boundary_surface_areas();
+    const auto reordered_areas = reordered_mesh->boundary_surface_areas();
+    REQUIRE(
+        std::accumulate(reordered_areas.begin(), reordered_areas.end(), 0.0)
+        == Approx(std::accumulate(areas.begin(), areas.end(), 0.0))
+        );
+
+    // The reordered mesh, partition sets included, can be written and read
+    // again on the same number of processes.
+    const std::string output_filename =
+      "reordered-" + ordering + "-" + input_filename_base + "-"
+      + std::to_string(size) + ".h5m";
+    reordered_mesh->write(output_filename);
+    auto reread_mesh = nosh::read(output_filename);
+    REQUIRE(
+        reread_mesh->edge_lids.size() == reordered_mesh->edge_lids.size()
+        );
+    REQUIRE(
+        reread_mesh->boundary_vertices.size()
+        == reordered_mesh->boundary_vertices.size()
+        );
+    const auto reread_control_vols = reread_mesh->control_volumes();
+    REQUIRE(
+        reread_control_vols->norm1() == Approx(control_vols->norm1())
+        );
+    REQUIRE(
+        reread_control_vols->norm2() == Approx(control_vols->norm2())
+        );
+  }
+
+  return;
+}
+// ============================================================================
+TEST_CASE("vertex reordering for pacman mesh", "[pacman]")
+{
+  testMeshReordering("pacman");
+}
+// ============================================================================
+TEST_CASE("vertex reordering for brick mesh", "[brick]")
+{
+  testMeshReordering("brick-w-hole");
+}
+// ============================================================================